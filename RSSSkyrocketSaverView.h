@@ -18,6 +18,7 @@
     BOOL preview_;
     BOOL mainScreen_;
 	BOOL soundDisabled_;
+	NSString *recordPath_;
 
     float times[10];
     int timeindex;
@@ -4,6 +4,7 @@
 
 #import "RSSSkyrocketSaverView.h"
 #include "Skyrocket.h"
+#include "showlog.h"
 #include <sys/time.h>
 #import <OpenGL/OpenGL.h>
 
@@ -112,6 +113,15 @@
     if (_view!=nil)
     {
         [_view setFrameSize:newSize];
+        
+        if ([self isAnimating] && isConfiguring_==NO && (mainScreenOnly_!=NSOnState || mainScreen_==YES))
+        {
+			NSSize tSize = [_view convertSizeToBacking:_view.frame.size];
+			
+            [[_view openGLContext] makeCurrentContext];
+            [[_view openGLContext] update];
+            reshape((int) tSize.width,(int) tSize.height,&settings_);
+        }
     }
 }
 
@@ -188,6 +198,8 @@
             //cleanSettings(&settings_);
 			
             initSaver((int) tSize.width,(int) tSize.height,&settings_);
+            if (recordPath_ != nil)
+                startRecording([recordPath_ fileSystemRepresentation], &settings_);
 
             for(i=0;i<10;i++)
             {
@@ -263,6 +275,24 @@
     settings_.dClouds=int([inDefaults integerForKey:@"DrawClouds"]);
     
     settings_.dIllumination=int([inDefaults integerForKey:@"Illumination"]);
+    
+	if ([inDefaults integerForKey:@"MaxParticles"] > 0)	// hidden preference; there's no UI for this
+		settings_.dMaxParticles = int([inDefaults integerForKey:@"MaxParticles"]);
+	if ([inDefaults objectForKey:@"Threads"])	// hidden preference; 0 = one thread per processor
+		settings_.dThreads = int([inDefaults integerForKey:@"Threads"]);
+	if ([inDefaults objectForKey:@"SIMD"])	// hidden preference; 0 = plain C++ particle movement
+		settings_.dSimd = int([inDefaults integerForKey:@"SIMD"]);
+	if ([inDefaults integerForKey:@"Seed"] > 0)	// hidden preference; makes every show the same
+		settings_.dSeed = (unsigned int)[inDefaults integerForKey:@"Seed"];
+	if ([inDefaults integerForKey:@"SimRate"] > 0)	// hidden preference; simulation ticks per second, independent of the frame rate
+		settings_.dSimRate = (int)[inDefaults integerForKey:@"SimRate"];
+	if ([inDefaults integerForKey:@"SmokeBlend"] == SMOKEBLEND_WEIGHTED)	// hidden preference; composite smoke without sorting it (oit.h)
+		settings_.dSmokeBlend = SMOKEBLEND_WEIGHTED;
+	if ([inDefaults objectForKey:@"MaxFlares"])	// hidden preference; most lens flares drawn at once, 0 = no limit
+		settings_.dMaxFlares = int([inDefaults integerForKey:@"MaxFlares"]);
+	if ([inDefaults integerForKey:@"FlareStyle"] == FLARESTYLE_SCREEN)	// hidden preference; lens flares as a post process (lensflare.h)
+		settings_.dFlareStyle = FLARESTYLE_SCREEN;
+	recordPath_ = [inDefaults stringForKey:@"RecordShow"];	// hidden preference; file to save a show log (showlog.h) to
 
     mainScreenOnly_=int([inDefaults integerForKey:@"MainScreen Only"]);
 }
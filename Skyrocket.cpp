@@ -40,18 +40,21 @@
 //#include "overlay.h"
 
 #include "Skyrocket.h"
-#include <OpenGL/gl.h>
-#include <OpenGL/glu.h>
 #include <stdio.h>
-#include "rsText.h"
 #include <math.h>
 #include <time.h>
 #include <vector>
 #include <list>
+#include <chrono>
 #include <stdlib.h>
+#include <algorithm>
+#include <new>
 #include "rsMath.h"
 #include "particle.h"
 #include "world.h"
+#include "workerpool.h"
+#include "kinematics.h"
+#include "showlog.h"
 
 // Global variables
 //LPCTSTR registryPath = ("Software\\Really Slick\\Skyrocket");
@@ -65,8 +68,6 @@
 // Window variables
 /*int xsize, ysize, centerx, centery;
 float aspectRatio;*/
-float gWidth, gHeight;
-float gFov, gHFov;
 // Camera variables
 /*static rsVec lookFrom[3];  // 3 = position, target position, last position
 static rsVec lookAt[3]  // 3 = position, target position, last position
@@ -81,9 +82,6 @@ rsVec cameraVel;  // used for doppler shift
 int mouseButtons, mousex, mousey;
 float mouseSpeed;*/
 
-// the sound engine
-SoundEngine* soundengine = NULL;
-
 // flare display lists
 //unsigned int flarelist[4];
 // matrix junk for drawing flares in screen space
@@ -140,241 +138,274 @@ unsigned int zoomRocket = ZOOMROCKETINACTIVE;*/
 
 
 
-particle* addParticle(SkyrocketSaverSettings *inSettings){
-	// Advance to new particle if there is another in the vector.
-	// Otherwise, just overwrite the last particle (this will probably never happen)
-	if(inSettings->last_particle < inSettings->particles.size())
-		++inSettings->last_particle;
+// spawn queue and stream of the update job that is running on this thread
+static thread_local spawnQueue* threadSpawnQueue = NULL;
+static thread_local updateStream* threadStream = NULL;
 
-	// Return pointer to new particle
-	return &(inSettings->particles[inSettings->last_particle-1]);
+static spawnQueue* currentSpawnQueue(SkyrocketSaverSettings *inSettings){
+	if(threadSpawnQueue)
+		return threadSpawnQueue;
+	return inSettings->spawnQueues[0];
 }
 
 
-void removeParticle(unsigned int rempart, SkyrocketSaverSettings *inSettings){
-	// copy last particle over particle to be removed
-	--inSettings->last_particle;
-	if(rempart != inSettings->last_particle)
-		inSettings->particles[rempart] = inSettings->particles[inSettings->last_particle];
+int& currentSomeSmoke(SkyrocketSaverSettings *inSettings){
+	if(threadStream)
+		return threadStream->someSmoke;
+	return inSettings->someSmoke;
+}
+
+
+// The particle store and spawn queues are sized once in initSaver() and never
+// grow while the saver runs.  Particles made during the update pass go into the
+// calling thread's spawn queue so the live set doesn't change underneath the
+// loop; mergeSpawns() adds them afterwards.
+particle addParticle(SkyrocketSaverSettings *inSettings){
+	if(inSettings->deferSpawns){
+		spawnQueue* queue(currentSpawnQueue(inSettings));
+		// last slot of each queue is kept as scratch space
+		if(queue->last + 1 < queue->store.capacity){
+			queue->store.reset(queue->last, inSettings);
+			return particle(queue->store, queue->last++);
+		}
+		++queue->dropped;
+		return particle(queue->store, queue->store.capacity - 1);
+	}
+	if(inSettings->last_particle < inSettings->particles.capacity){
+		inSettings->particles.reset(inSettings->last_particle, inSettings);
+		return particle(inSettings->particles, inSettings->last_particle++);
+	}
+
+	// No room.  Give the caller the scratch slot to write into so that no
+	// other particle gets overwritten, and count the loss.
+	++inSettings->droppedParticles;
+	spawnQueue* queue(inSettings->spawnQueues[0]);
+	return particle(queue->store, queue->store.capacity - 1);
+}
+
 
-	// correct zoomRocket index if necessary
-	if(inSettings->zoomRocket == inSettings->last_particle)
-		inSettings->zoomRocket = rempart;
+// Move count particles from slot first of a spawn queue into the live set
+static void mergeRun(spawnQueue* queue, unsigned int first, unsigned int count, SkyrocketSaverSettings *inSettings){
+	const unsigned int room(inSettings->particles.capacity - inSettings->last_particle);
+	if(count > room){
+		queue->dropped += count - room;
+		count = room;
+	}
+	inSettings->particles.copy(inSettings->last_particle, queue->store, first, count);
+	// New particles haven't moved yet, so there is nothing to draw them
+	// moving from (see tickFraction)
+	particleStore& store(inSettings->particles);
+	for(unsigned int j=inSettings->last_particle; j<inSettings->last_particle+count; ++j)
+		particle(store, j).lastxyz = particle(store, j).xyz;
+	inSettings->last_particle += count;
+	inSettings->stats.spawned += count;
 }
 
 
-void sortParticles(){
-	// Sorting doesn't appear to be necessary.  Skyrocket still looks good without it.
+// Move particles from the spawn queues into the live set:  first what each
+// chunk of the update range spawned, in chunk order, and then what the main
+// thread spawned after the update (it comes after the runs in the first queue).
+// The order doesn't depend on how many threads did the updating.
+void mergeSpawns(SkyrocketSaverSettings *inSettings){
+	std::vector<spawnQueue*>& queues(inSettings->spawnQueues);
+	std::vector<unsigned int> next(queues.size(), 0);  // each queue's next run
+	for(;;){
+		unsigned int q(queues.size());
+		for(unsigned int i=0; i<queues.size(); ++i){
+			if(next[i] < queues[i]->runs.size()
+				&& (q == queues.size() || queues[i]->runs[next[i]].chunk < queues[q]->runs[next[q]].chunk))
+				q = i;
+		}
+		if(q == queues.size())
+			break;
+		const spawnRun& run(queues[q]->runs[next[q]++]);
+		mergeRun(queues[q], run.first, run.count, inSettings);
+	}
+	spawnQueue* mainQueue(queues[0]);
+	const unsigned int mainFirst(mainQueue->runs.empty() ? 0 : mainQueue->runs.back().first + mainQueue->runs.back().count);
+	mergeRun(mainQueue, mainFirst, mainQueue->last - mainFirst, inSettings);
+
+	for(unsigned int i=0; i<queues.size(); ++i){
+		inSettings->droppedParticles += queues[i]->dropped;
+		queues[i]->last = 0;
+		queues[i]->dropped = 0;
+		queues[i]->runs.clear();
+	}
 }
 
 
-// Rockets and explosions illuminate smoke
-// Only explosions illuminate clouds
+// Particles are updated in chunks of this many, each with its own random numbers
+#define UPDATECHUNK 1024
+// Fewer particles than this per thread aren't worth waking the thread for
+#define UPDATESPERJOB 1000
+
+
+// A range of particles to be updated.  The range is cut into chunks of
+// UPDATECHUNK particles, which are dealt out to the jobs like cards.
+struct updateJob{
+	SkyrocketSaverSettings* settings;
+	unsigned int first, count, jobs;
+};
+
+
+// Update one job's chunks of an updateJob.  Each chunk uses its own random
+// number stream and keeps track of what it spawns, so results depend on
+// neither timing nor the number of jobs.
+static void updateChunks(unsigned int job, void* data){
+	updateJob* work = (updateJob*)data;
+	if(job >= work->jobs)
+		return;
+	SkyrocketSaverSettings* inSettings = work->settings;
+	const unsigned int end(work->first + work->count);
+	const unsigned int chunks((work->count + UPDATECHUNK - 1) / UPDATECHUNK);
+
+	spawnQueue* queue(inSettings->spawnQueues[job]);
+	threadSpawnQueue = queue;
+	rsRandom* oldRandom(rsCurrentRandom);
+	for(unsigned int c=job; c<chunks; c+=work->jobs){
+		const unsigned int first(work->first + c * UPDATECHUNK);
+		const unsigned int last(std::min(first + UPDATECHUNK, end));
+		threadStream = &inSettings->updateStreams[c];
+		rsCurrentRandom = &threadStream->random;
+		spawnRun run;
+		run.chunk = c;
+		run.first = queue->last;
+		// thrust for rockets and bees, then gravity, drag, and movement for everything
+		for(unsigned int i=first; i<last; ++i){
+			if(inSettings->particles.type[i] == ROCKET || inSettings->particles.type[i] == BEE)
+				particle(inSettings->particles, i).accelerate(inSettings);
+		}
+		integrateParticles(inSettings->particles, first, last, inSettings->frameTime, float(inSettings->dWind));
+		for(unsigned int i=first; i<last; ++i){
+			particle curpart(inSettings->particles, i);
+			curpart.update(inSettings);
+			curpart.findDepth(inSettings);
+		}
+		run.count = queue->last - run.first;
+		if(run.count)
+			queue->runs.push_back(run);
+	}
+	threadSpawnQueue = NULL;
+	threadStream = NULL;
+	rsCurrentRandom = oldRandom;
+}
+
+
+// Update particles first through last-1 on the worker threads
+void updateParticles(unsigned int first, unsigned int last, SkyrocketSaverSettings *inSettings){
+	updateJob work;
+	work.settings = inSettings;
+	work.first = first;
+	work.count = last - first;
+	work.jobs = std::max(1u, std::min(work.count / UPDATESPERJOB, inSettings->workers->size()));
+	if(work.jobs == 1)
+		updateChunks(0, &work);
+	else
+		inSettings->workers->run(updateChunks, &work);
+}
+
+
+// Finish updating particle i:  count rockets and turn particles that are done
+// into whatever comes next (rockets explode, and so on).  Returns 0 if the
+// particle is dead and should be removed.
+static int finishUpdate(unsigned int i, SkyrocketSaverSettings *inSettings){
+	particle curpart(inSettings->particles, i);
+	if(curpart.type == ROCKET)
+		inSettings->numRockets++;
+	if(curpart.life > 0.0f && curpart.xyz[1] >= 0.0f)
+		return 1;
+
+	switch(curpart.type){
+	case ROCKET:
+		if(curpart.xyz[1] <= 0.0f){
+			// move above ground for explosion so new particles aren't removed
+			curpart.xyz[1] = 0.1f;
+			curpart.vel[1] *= -0.7f;
+		}
+		if(curpart.explosiontype == 18)
+			curpart.initSpinner(inSettings);
+		else
+			curpart.initExplosion(inSettings);
+		break;
+	case POPPER:
+		switch(curpart.explosiontype){
+		case STAR:
+			curpart.explosiontype = 100;
+			curpart.initExplosion(inSettings);
+			break;
+		case STREAMER:
+			curpart.explosiontype = 101;
+			curpart.initExplosion(inSettings);
+			break;
+		case METEOR:
+			curpart.explosiontype = 102;
+			curpart.initExplosion(inSettings);
+			break;
+		case POPPER:
+			curpart.type = STAR;
+			curpart.rgb.set(1.0f, 0.8f, 0.6f);
+			curpart.t = curpart.tr = curpart.life = 0.2f;
+		}
+		break;
+	case SUCKER:
+		curpart.initShockwave(inSettings);
+		break;
+	case STRETCHER:
+		curpart.initBigmama(inSettings);
+	}
+
+	return curpart.life > 0.0f && curpart.xyz[1] >= 0.0f;
+}
+
+
+// Rockets and explosions illuminate smoke.  Only explosions illuminate clouds.
+// Smoke and clouds are lit all at once after every light has been added
+// (see smokeLighting and World::lightClouds()).
 void illuminate(particle* ill,SkyrocketSaverSettings * inSettings){
-	float temp;
 	// desaturate illumination colors
 	rsVec newrgb(ill->rgb[0] * 0.6f + 0.4f, ill->rgb[1] * 0.6f + 0.4f, ill->rgb[2] * 0.6f + 0.4f);
 
 	// Smoke illumination
+	float lightdistsquared(0.0f), lightscale(0.0f);
 	if((ill->type == ROCKET) || (ill->type == FOUNTAIN)){
-		float distsquared;
-		for(unsigned int i=0; i<inSettings->last_particle; ++i){
-			particle* smk(&(inSettings->particles[i]));
-			if(smk->type == SMOKE){
-				distsquared = (ill->xyz[0] - smk->xyz[0]) * (ill->xyz[0] - smk->xyz[0])
-					+ (ill->xyz[1] - smk->xyz[1]) * (ill->xyz[1] - smk->xyz[1])
-					+ (ill->xyz[2] - smk->xyz[2]) * (ill->xyz[2] - smk->xyz[2]);
-				if(distsquared < 40000.0f){
-					temp = (40000.0f - distsquared) * 0.000025f;
-					temp = temp * temp * ill->bright;
-					smk->rgb[0] += temp * newrgb[0];
-					if(smk->rgb[0] > 1.0f)
-						smk->rgb[0] = 1.0f;
-					smk->rgb[1] += temp * newrgb[1];
-					if(smk->rgb[1] > 1.0f)
-						smk->rgb[1] = 1.0f;
-					smk->rgb[2] += temp * newrgb[2];
-					if(smk->rgb[2] > 1.0f)
-						smk->rgb[2] = 1.0f;
-				}
-			}
-		}
+		lightdistsquared = 40000.0f;
+		lightscale = 0.000025f;
 	}
 	if(ill->type == EXPLOSION){
-		float distsquared;
-		for(unsigned int i=0; i<inSettings->last_particle; ++i){
-			particle* smk(&(inSettings->particles[i]));
-			if(smk->type == SMOKE){
-				distsquared = (ill->xyz[0] - smk->xyz[0]) * (ill->xyz[0] - smk->xyz[0])
-					+ (ill->xyz[1] - smk->xyz[1]) * (ill->xyz[1] - smk->xyz[1])
-					+ (ill->xyz[2] - smk->xyz[2]) * (ill->xyz[2] - smk->xyz[2]);
-				if(distsquared < 640000.0f){
-					temp = (640000.0f - distsquared) * 0.0000015625f;
-					temp = temp * temp * ill->bright;
-					smk->rgb[0] += temp * newrgb[0];
-					if(smk->rgb[0] > 1.0f)
-						smk->rgb[0] = 1.0f;
-					smk->rgb[1] += temp * newrgb[1];
-					if(smk->rgb[1] > 1.0f)
-						smk->rgb[1] = 1.0f;
-					smk->rgb[2] += temp * newrgb[2];
-					if(smk->rgb[2] > 1.0f)
-						smk->rgb[2] = 1.0f;
-				}
-			}
-		}
+		lightdistsquared = 640000.0f;
+		lightscale = 0.0000015625f;
+	}
+	if(lightdistsquared > 0.0f){
+		const float xyz[3] = {ill->xyz[0], ill->xyz[1], ill->xyz[2]};
+		inSettings->smokeLights.add(xyz, newrgb.v, ill->bright, lightdistsquared, lightscale);
 	}
 
 	// cloud illumination
 	if(ill->type == EXPLOSION && inSettings->dClouds){
-		int north, south, west, east;  // limits of cloud indices to inspect
-		int halfmesh = CLOUDMESH / 2;
-		float distsquared;
-		// remember clouds have 20000-foot radius from the World class, hence 0.00005
-		// Hardcoded values like this are evil, but oh well
-		south = int((ill->xyz[2] - 1600.0f) * 0.00005f * float(halfmesh)) + halfmesh;
-		north = int((ill->xyz[2] + 1600.0f) * 0.00005f * float(halfmesh) + 0.5f) + halfmesh;
-		west = int((ill->xyz[0] - 1600.0f) * 0.00005f * float(halfmesh)) + halfmesh;
-		east = int((ill->xyz[0] + 1600.0f) * 0.00005f * float(halfmesh) + 0.5f) + halfmesh;
-		// bound these values just in case
-		if(south < 0) south = 0; if(south > CLOUDMESH-1) south = CLOUDMESH-1;
-		if(north < 0) north = 0; if(north > CLOUDMESH-1) north = CLOUDMESH-1;
-		if(west < 0) west = 0; if(west > CLOUDMESH-1) west = CLOUDMESH-1;
-		if(east < 0) east = 0; if(east > CLOUDMESH-1) east = CLOUDMESH-1;
-		//do any necessary cloud illumination
-		for(int i=west; i<=east; i++){
-			for(int j=south; j<=north; j++){
-				distsquared = (inSettings->theWorld->clouds[i][j][0] - ill->xyz[0]) * (inSettings->theWorld->clouds[i][j][0] - ill->xyz[0])
-					+ (inSettings->theWorld->clouds[i][j][1] - ill->xyz[1]) * (inSettings->theWorld->clouds[i][j][1] - ill->xyz[1])
-					+ (inSettings->theWorld->clouds[i][j][2] - ill->xyz[2]) * (inSettings->theWorld->clouds[i][j][2] - ill->xyz[2]);
-				if(distsquared < 2560000.0f){
-					temp = (2560000.0f - distsquared) * 0.000000390625f;
-					temp = temp * temp * ill->bright;
-					inSettings->theWorld->clouds[i][j][6] += temp * newrgb[0];
-					if(inSettings->theWorld->clouds[i][j][6] > 1.0f)
-						inSettings->theWorld->clouds[i][j][6] = 1.0f;
-					inSettings->theWorld->clouds[i][j][7] += temp * newrgb[1];
-					if(inSettings->theWorld->clouds[i][j][7] > 1.0f)
-						inSettings->theWorld->clouds[i][j][7] = 1.0f;
-					inSettings->theWorld->clouds[i][j][8] += temp * newrgb[2];
-					if(inSettings->theWorld->clouds[i][j][8] > 1.0f)
-						inSettings->theWorld->clouds[i][j][8] = 1.0f;
-				}
-			}
-		}
+		const float xyz[3] = {ill->xyz[0], ill->xyz[1], ill->xyz[2]};
+		inSettings->theWorld->addCloudLight(xyz, newrgb.v, ill->bright);
 	}
 }
 
 
 // pulling of other particles
 void pulling(particle* suck,SkyrocketSaverSettings * inSettings){
-	rsVec diff;
-	float pulldistsquared;
-	float pullconst = (1.0f - suck->life) * 0.01f * inSettings->frameTime;
-
-	for(unsigned int i=0; i<inSettings->last_particle; ++i){
-		particle* puller(&(inSettings->particles[i]));
-		diff = suck->xyz - puller->xyz;
-		pulldistsquared = diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2];
-		if(pulldistsquared < 250000.0f && pulldistsquared != 0.0f){
-			if(puller->type != SUCKER && puller->type != STRETCHER
-				&& puller->type != SHOCKWAVE && puller->type != BIGMAMA){
-				diff.normalize();
-				puller->vel += diff * ((250000.0f - pulldistsquared) * pullconst);
-			}
-		}
-	}
+	const float xyz[3] = {suck->xyz[0], suck->xyz[1], suck->xyz[2]};
+	inSettings->forces.add(FORCE_PULL, xyz, (1.0f - suck->life) * 0.01f * inSettings->frameTime);
 }
 
 
 // pushing of other particles
 void pushing(particle* shock,SkyrocketSaverSettings * inSettings){
-	rsVec diff;
-	float pushdistsquared;
-	float pushconst = (1.0f - shock->life) * 0.002f * inSettings->frameTime;
-
-	for(unsigned int i=0; i<inSettings->last_particle; ++i){
-		particle* pusher(&(inSettings->particles[i]));
-		diff = pusher->xyz - shock->xyz;
-		pushdistsquared = diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2];
-		if(pushdistsquared < 640000.0f && pushdistsquared != 0.0f){
-			if(pusher->type != SUCKER && pusher->type != STRETCHER
-				&& pusher->type != SHOCKWAVE && pusher->type != BIGMAMA){
-				diff.normalize();
-				pusher->vel += diff * ((640000.0f - pushdistsquared) * pushconst);
-			}
-		}
-	}
+	const float xyz[3] = {shock->xyz[0], shock->xyz[1], shock->xyz[2]};
+	inSettings->forces.add(FORCE_PUSH, xyz, (1.0f - shock->life) * 0.002f * inSettings->frameTime);
 }
 
 
 // vertical stretching of other particles (x, z sucking; y pushing)
 void stretching(particle* stretch,SkyrocketSaverSettings * inSettings){
-	rsVec diff;
-	float stretchdistsquared, temp;
-	float stretchconst = (1.0f - stretch->life) * 0.002f * inSettings->frameTime;
-
-	for(unsigned int i=0; i<inSettings->last_particle; ++i){
-		particle* stretcher(&(inSettings->particles[i]));
-		diff = stretch->xyz - stretcher->xyz;
-		stretchdistsquared = diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2];
-		if(stretchdistsquared < 640000.0f && stretchdistsquared != 0.0f && stretcher->type != STRETCHER){
-			diff.normalize();
-			temp = (640000.0f - stretchdistsquared) * stretchconst;
-			stretcher->vel[0] += diff[0] * temp * 5.0f;
-			stretcher->vel[1] -= diff[1] * temp;
-			stretcher->vel[2] += diff[2] * temp * 5.0f;
-		}
-	}
-}
-
-
-// Makes list of lens flares.  Must be a called even when action is paused
-// because camera might still be moving.
-void makeFlareList(SkyrocketSaverSettings * inSettings){
-	rsVec cameraDir, partDir;
-	const float shine(float(inSettings->dFlare) * 0.01f);
-
-	cameraDir = inSettings->lookAt[0] - inSettings->lookFrom[0];
-	cameraDir.normalize();
-	for(unsigned int i=0; i<inSettings->last_particle; ++i){
-		particle* curlight(&(inSettings->particles[i]));
-		if(curlight->type == EXPLOSION || curlight->type == SUCKER
-			|| curlight->type == SHOCKWAVE || curlight->type == STRETCHER
-			|| curlight->type == BIGMAMA){
-			double winx, winy, winz;
-			gluProject(curlight->xyz[0], curlight->xyz[1], curlight->xyz[2],
-				inSettings->modelMat, inSettings->projMat, inSettings->viewport,
-				&winx, &winy, &winz);
-			partDir = curlight->xyz - inSettings->cameraPos;
-			if(partDir.dot(cameraDir) > 1.0f){  // is light source in front of camera?
-				if(inSettings->numFlares == inSettings->lensFlares.size())
-					inSettings->lensFlares.resize(inSettings->lensFlares.size() + 10);
-				inSettings->lensFlares[inSettings->numFlares].x = (float(winx) / float(inSettings->xsize)) * inSettings->aspectRatio;
-				inSettings->lensFlares[inSettings->numFlares].y = float(winy) / float(inSettings->ysize);
-				rsVec vec = curlight->xyz - inSettings->cameraPos;  // find distance attenuation factor
-				if(curlight->type == EXPLOSION){
-					inSettings->lensFlares[inSettings->numFlares].r = curlight->rgb[0];
-					inSettings->lensFlares[inSettings->numFlares].g = curlight->rgb[1];
-					inSettings->lensFlares[inSettings->numFlares].b = curlight->rgb[2];
-					float distatten = (10000.0f - vec.length()) * 0.0001f;
-					if(distatten < 0.0f)
-						distatten = 0.0f;
-					inSettings->lensFlares[inSettings->numFlares].a = curlight->bright * shine * distatten;
-				}
-				else{
-					inSettings->lensFlares[inSettings->numFlares].r = 1.0f;
-					inSettings->lensFlares[inSettings->numFlares].g = 1.0f;
-					inSettings->lensFlares[inSettings->numFlares].b = 1.0f;
-					float distatten = (20000.0f - vec.length()) * 0.00005f;
-					if(distatten < 0.0f)
-						distatten = 0.0f;
-					inSettings->lensFlares[inSettings->numFlares].a = curlight->bright * 2.0f * shine * distatten;
-				}
-				inSettings->numFlares++;
-			}
-		}
-	}
+	const float xyz[3] = {stretch->xyz[0], stretch->xyz[1], stretch->xyz[2]};
+	inSettings->forces.add(FORCE_STRETCH, xyz, (1.0f - stretch->life) * 0.002f * inSettings->frameTime);
 }
 
 
@@ -389,7 +420,7 @@ void randomLookAt(int n, SkyrocketSaverSettings *inSettings){
 	// look left or right some amount within HFov.  This way, if there is a really
 	// wide FOV due to a wide screen or multiple monitors, the action will appear off
 	// to the sides sometimes.
-	float shift_angle = (gHFov * 0.5f) - 15.0f;
+	float shift_angle = (inSettings->hFov * 0.5f) - 15.0f;
 	if(shift_angle < 0.0f)
 		shift_angle = 0.0f;
 	const float shift = tanf(shift_angle / RS_RAD2DEG);
@@ -411,45 +442,87 @@ void findHeadingAndPitch(rsVec lookFrom, rsVec lookAt, float& heading, float& pi
 }
 
 
-void reshape(SkyrocketSaverSettings *inSettings){
-	// build viewing matrix
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	if(inSettings->aspectRatio > 1.0f){
-		gHFov = 2.0f * RS_RAD2DEG * atanf(tanf(gFov * 0.5f / RS_RAD2DEG) * inSettings->aspectRatio);
-		gluPerspective(gFov, inSettings->aspectRatio, 1.0f, 40000.0f);
+// Horizontal field of view for the current fov and window shape
+static void findHFov(SkyrocketSaverSettings *inSettings){
+	if(inSettings->aspectRatio > 1.0f)
+		inSettings->hFov = 2.0f * RS_RAD2DEG * atanf(tanf(inSettings->fov * 0.5f / RS_RAD2DEG) * inSettings->aspectRatio);
+	else
+		inSettings->hFov = inSettings->fov;
+}
+
+
+// Only the main thread makes sounds (launches and explosions), so the list
+// needs no locking.
+void queueSound(int sound, const rsVec &pos, SkyrocketSaverSettings *inSettings){
+	soundEvent event;
+	event.sound = sound;
+	event.pos[0] = pos[0];
+	event.pos[1] = pos[1];
+	event.pos[2] = pos[2];
+	inSettings->soundEvents.push_back(event);
+}
+
+
+// set smoke lifespans and the table of which particles make smoke
+static void initSmokeTimes(SkyrocketSaverSettings *inSettings){
+	int i;
+
+	// set smoke lifespans  ( 1 2 1 4 1 2 1 8 )
+	// This deserves a little more explanation:  smoke particles in this saver expand
+	// over time.  If they all have the same lifespans, then they overlap too much and
+	// that looks bad.  If every other particle fades out, the remaining ones have more
+	// room to expand into.  So we use these smoke times to halve the number of particles
+	// a few times.
+	inSettings->smokeTime[0] = inSettings->smokeTime[2] = inSettings->smokeTime[4] = inSettings->smokeTime[6] = 0.4f;
+	inSettings->smokeTime[1] = inSettings->smokeTime[5] = 0.8f;
+	inSettings->smokeTime[3] = 2.0f;
+	inSettings->smokeTime[7] = 4.0f;
+	for(i=0; i<SMOKETIMES; i++){
+		if(inSettings->smokeTime[i] > float(inSettings->dSmoke))
+			inSettings->smokeTime[i] = float(inSettings->dSmoke);
 	}
-	else{
-		gHFov = gFov;
-		gluPerspective(2.0f * RS_RAD2DEG * atanf(tanf(gFov * 0.5f / RS_RAD2DEG) / inSettings->aspectRatio), inSettings->aspectRatio, 1.0f, 40000.0f);
+	if(inSettings->smokeTime[7] < float(inSettings->dSmoke))
+		inSettings->smokeTime[7] = float(inSettings->dSmoke);
+
+	// create table describing which particles will emit smoke
+	// 0 = don't emit smoke
+	// 1 = emit smoke
+	for(i=0; i<WHICHSMOKES; i++)
+		inSettings->whichSmoke[i] = 0;
+	if(inSettings->dExplosionsmoke){
+		float index = float(WHICHSMOKES) / float(inSettings->dExplosionsmoke);
+		for(i=0; i<inSettings->dExplosionsmoke; i++)
+			inSettings->whichSmoke[int(float(i) * index)] = 1;
 	}
-	glGetDoublev(GL_PROJECTION_MATRIX, inSettings->projMat);
 }
 
 
-__private_extern__ void draw(SkyrocketSaverSettings * inSettings){
-	/*static float cameraAngle = 0.0f;
-	static const float firstHeading = rsRandf(2.0f * PIx2);
-	static const float firstRadius = rsRandf(2000.0f);*/
-	static int lastCameraMode = inSettings->kCamera;
-	static float cameraTime[3]  // time, elapsed time, step (1.0 - 0.0)
-		= {20.0f, 0.0f, 0.0f};
-	static float zoom = 0.0f;  // For interpolating from regular camera view to zoomed in view
-	static float zoomTime[2] = {300.0f, 0.0f};  // time until next zoom, duration of zoom
-	static float heading, pitch;
-	static float zoomHeading = 0.0f;
-	static float zoomPitch = 0.0f;
-
-	// Variables for printing text
-	static float computeTime = 0.0f;
-	static float drawTime = 0.0f;
-	//static rsTimer computeTimer, drawTimer;
-	// start compute time timer
-	//computeTimer.tick();
+// Seconds from some fixed point in the past, for timing the parts of updateSim()
+static double simClock(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Run one frame of the show:  camera, rocket launches, particles, illumination,
+// and sound events, all advanced by inSettings->frameTime.  Nothing here touches
+// OpenGL.  draw() (render.cpp) calls this and then renders the results.
+void updateSim(SkyrocketSaverSettings *inSettings){
+	simStats& stats(inSettings->stats);
+	double clock(simClock()), now;
+	stats = simStats();
+
+	logFrame(inSettings);
+
+	// Everything on this thread uses this show's random numbers
+	rsCurrentRandom = &inSettings->random;
+
+	// last frame's sounds have been handed off by now
+	inSettings->soundEvents.clear();
 
 	// super fast easter egg
-	static int superFast = rsRandi(1000);
-	if(!superFast)
+	if(inSettings->first)
+		inSettings->superFast = !rsRandi(1000);
+	if(inSettings->superFast && !inSettings->dSimRate)  // stepSim() does this with more ticks
 		inSettings->frameTime *= 5.0f;
 
 	////////////////////////////////
@@ -462,72 +535,71 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 		// starting camera view is very far away
 		inSettings->lookFrom[2] = rsVec(rsRandf(1000.0f) + 6000.0f, 5.0f, rsRandf(4000.0f) - 2000.0f);
 		randomLookAt(2, inSettings);
-		inSettings->textwriter = new rsText;
 		inSettings->first = 0;
 	}
 
 	// Make new random camera view
 	if(inSettings->kNewCamera){
-		cameraTime[0] = rsRandf(25.0f) + 5.0f;
-		cameraTime[1] = 0.0f;
-		cameraTime[2] = 0.0f;
+		inSettings->cameraTime[0] = rsRandf(25.0f) + 5.0f;
+		inSettings->cameraTime[1] = 0.0f;
+		inSettings->cameraTime[2] = 0.0f;
 		// choose new positions
 		randomLookFrom(1, inSettings);  // new target position
 		randomLookAt(1, inSettings);  // new target position
 		// cut to a new view
 		randomLookFrom(2, inSettings);  // new last position
 		randomLookAt(2, inSettings);  // new last position
-		findHeadingAndPitch(inSettings->lookFrom[0], inSettings->lookAt[0], heading, pitch);	// add by NZ - update theading and pitch
+		findHeadingAndPitch(inSettings->lookFrom[0], inSettings->lookAt[0], inSettings->heading, inSettings->pitch);	// add by NZ - update theading and pitch
 		inSettings->kNewCamera = 0;
 	}
 
 	// Update the camera if it is active
 	if(inSettings->kCamera == 1){
-		if(lastCameraMode == 2){  // camera was controlled by mouse last frame
-			cameraTime[0] = 10.0f;
-			cameraTime[1] = 0.0f;
-			cameraTime[2] = 0.0f;
+		if(inSettings->lastCameraMode == 2){  // camera was controlled by mouse last frame
+			inSettings->cameraTime[0] = 10.0f;
+			inSettings->cameraTime[1] = 0.0f;
+			inSettings->cameraTime[2] = 0.0f;
 			inSettings->lookFrom[2] = inSettings->lookFrom[0];
 			randomLookFrom(1, inSettings);  // new target position
 			inSettings->lookAt[2] = inSettings->lookAt[0];
 			randomLookAt(1, inSettings);  // new target position
 		}
-		cameraTime[1] += inSettings->frameTime;
-		cameraTime[2] = cameraTime[1] / cameraTime[0];
-		if(cameraTime[2] >= 1.0f){  // reset camera sequence
+		inSettings->cameraTime[1] += inSettings->frameTime;
+		inSettings->cameraTime[2] = inSettings->cameraTime[1] / inSettings->cameraTime[0];
+		if(inSettings->cameraTime[2] >= 1.0f){  // reset camera sequence
 			// reset timer
-			cameraTime[0] = rsRandf(25.0f) + 5.0f;
-			cameraTime[1] = 0.0f;
-			cameraTime[2] = 0.0f;
+			inSettings->cameraTime[0] = rsRandf(25.0f) + 5.0f;
+			inSettings->cameraTime[1] = 0.0f;
+			inSettings->cameraTime[2] = 0.0f;
 			// choose new positions
 			inSettings->lookFrom[2] = inSettings->lookFrom[1];  // last = target
 			randomLookFrom(1, inSettings);  // new target position
 			inSettings->lookAt[2] = inSettings->lookAt[1];  // last = target
 			randomLookAt(1, inSettings);  // new target position
-			if(!rsRandi(4) && zoom == 0.0f){  // possibly cut to new view if camera isn't zoomed in
+			if(!rsRandi(4) && inSettings->zoom == 0.0f){  // possibly cut to new view if camera isn't zoomed in
 				randomLookFrom(2, inSettings);  // new last position
 				randomLookAt(2, inSettings);
 			}
 		}
 		// change camera position and angle
-		float cameraStep = 0.5f * (1.0f - cosf(cameraTime[2] * PI));
+		float cameraStep = 0.5f * (1.0f - cosf(inSettings->cameraTime[2] * PI));
 		inSettings->lookFrom[0] = inSettings->lookFrom[2] + ((inSettings->lookFrom[1] - inSettings->lookFrom[2]) * cameraStep);
 		inSettings->lookAt[0] = inSettings->lookAt[2] + ((inSettings->lookAt[1] - inSettings->lookAt[2]) * cameraStep);
 		// update variables used for sound and lens flares
 		inSettings->cameraVel = inSettings->lookFrom[0] - inSettings->cameraPos;
 		inSettings->cameraPos = inSettings->lookFrom[0];
 		// find heading and pitch
-		findHeadingAndPitch(inSettings->lookFrom[0], inSettings->lookAt[0], heading, pitch);
+		findHeadingAndPitch(inSettings->lookFrom[0], inSettings->lookAt[0], inSettings->heading, inSettings->pitch);
 
 		// zoom in on rockets with camera
-		zoomTime[0] -= inSettings->frameTime;
-		if(zoomTime[0] < 0.0f){
+		inSettings->zoomTime[0] -= inSettings->frameTime;
+		if(inSettings->zoomTime[0] < 0.0f){
 			if(inSettings->zoomRocket == ZOOMROCKETINACTIVE){  // try to find a rocket to follow
 				for(unsigned int i=0; i<inSettings->last_particle; ++i){
-					if(inSettings->particles[i].type == ROCKET){
+					if(inSettings->particles.type[i] == ROCKET){
 						inSettings->zoomRocket = i;
-						if(inSettings->particles[inSettings->zoomRocket].tr > 4.0f){
-							zoomTime[1] = inSettings->particles[inSettings->zoomRocket].tr;
+						if(inSettings->particles.tr[inSettings->zoomRocket] > 4.0f){
+							inSettings->zoomTime[1] = inSettings->particles.tr[inSettings->zoomRocket];
 							// get out of for loop if a suitable rocket has been found
 							i = inSettings->last_particle;
 						}
@@ -536,33 +608,33 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 					}
 				}
 				if(inSettings->zoomRocket == ZOOMROCKETINACTIVE)
-					zoomTime[0] = 5.0f;
+					inSettings->zoomTime[0] = 5.0f;
 			}
 			if(inSettings->zoomRocket != ZOOMROCKETINACTIVE){  // zoom in on this rocket
-				zoom += inSettings->frameTime * 0.5f;
-				if(zoom > 1.0f)
-					zoom = 1.0f;
-				zoomTime[1] -= inSettings->frameTime;
+				inSettings->zoom += inSettings->frameTime * 0.5f;
+				if(inSettings->zoom > 1.0f)
+					inSettings->zoom = 1.0f;
+				inSettings->zoomTime[1] -= inSettings->frameTime;
 				float h, p;
-				findHeadingAndPitch(inSettings->lookFrom[0], inSettings->particles[inSettings->zoomRocket].xyz, h, p);
+				findHeadingAndPitch(inSettings->lookFrom[0], particle(inSettings->particles, inSettings->zoomRocket).xyz, h, p);
 				// Don't wrap around
-				while(h - heading < -180.0f)
+				while(h - inSettings->heading < -180.0f)
 					h += 360.0f;
-				while(h - heading > 180.0f)
+				while(h - inSettings->heading > 180.0f)
 					h -= 360.0f;
-				while(zoomHeading - h < -180.0f)
-					zoomHeading += 360.0f;
-				while(zoomHeading - h > 180.0f)
-					zoomHeading -= 360.0f;
+				while(inSettings->zoomHeading - h < -180.0f)
+					inSettings->zoomHeading += 360.0f;
+				while(inSettings->zoomHeading - h > 180.0f)
+					inSettings->zoomHeading -= 360.0f;
 				// Make zoomed heading and pitch follow rocket closely but not exactly.
 				// It would look weird because the rockets wobble sometimes.
-				zoomHeading += (h - zoomHeading) * 10.0f * inSettings->frameTime;
-				zoomPitch += (p - zoomPitch) * 5.0f * inSettings->frameTime;
+				inSettings->zoomHeading += (h - inSettings->zoomHeading) * 10.0f * inSettings->frameTime;
+				inSettings->zoomPitch += (p - inSettings->zoomPitch) * 5.0f * inSettings->frameTime;
 				// End zooming
-				if(zoomTime[1] < 0.0f){
+				if(inSettings->zoomTime[1] < 0.0f){
 					inSettings->zoomRocket = ZOOMROCKETINACTIVE;
 					// Zoom in again no later than 3 minutes from now
-					zoomTime[0] = rsRandf(175.0f) + 5.0f;
+					inSettings->zoomTime[0] = rsRandf(175.0f) + 5.0f;
 				}
 			}
 		}
@@ -570,25 +642,25 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 
 	// Still counting down to zoom in on a rocket,
 	// so keep zoomed out.
-	if(zoomTime[0] > 0.0f){
-		zoom -= inSettings->frameTime * 0.5f;
-		if(zoom < 0.0f)
-			zoom = 0.0f;
+	if(inSettings->zoomTime[0] > 0.0f){
+		inSettings->zoom -= inSettings->frameTime * 0.5f;
+		if(inSettings->zoom < 0.0f)
+			inSettings->zoom = 0.0f;
 	}
 
 	// Control camera with the mouse
 	if(inSettings->kCamera == 2){
 		// find heading and pitch to compute rotation component of modelview matrix
-		heading += 100.0f * inSettings->frameTime * inSettings->aspectRatio * float(inSettings->centerx - inSettings->mousex) / float(inSettings->xsize);
-		pitch += 100.0f * inSettings->frameTime * float(inSettings->centery - inSettings->mousey) / float(inSettings->ysize);
-		if(heading > 180.0f)
-			heading -= 360.0f;
-		if(heading < -180.0f)
-			heading += 360.0f;
-		if(pitch > 90.0f)
-			pitch = 90.0f;
-		if(pitch < -90.0f)
-			pitch = -90.0f;
+		inSettings->heading += 100.0f * inSettings->frameTime * inSettings->aspectRatio * float(inSettings->centerx - inSettings->mousex) / float(inSettings->xsize);
+		inSettings->pitch += 100.0f * inSettings->frameTime * float(inSettings->centery - inSettings->mousey) / float(inSettings->ysize);
+		if(inSettings->heading > 180.0f)
+			inSettings->heading -= 360.0f;
+		if(inSettings->heading < -180.0f)
+			inSettings->heading += 360.0f;
+		if(inSettings->pitch > 90.0f)
+			inSettings->pitch = 90.0f;
+		if(inSettings->pitch < -90.0f)
+			inSettings->pitch = -90.0f;
 		if(inSettings->mouseButtons & MK_LBUTTON)
 			inSettings->mouseSpeed += 400.0f * inSettings->frameTime;
 		if(inSettings->mouseButtons & MK_RBUTTON)
@@ -600,10 +672,10 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 		if(inSettings->mouseSpeed < -4000.0f)
 			inSettings->mouseSpeed = -4000.0f;
 		// find lookFrom location to compute translation component of modelview matrix
-		float ch = cosf(D2R * heading);
-		float sh = sinf(D2R * heading);
-		float cp = cosf(D2R * pitch);
-		float sp = sinf(D2R * pitch);
+		float ch = cosf(D2R * inSettings->heading);
+		float sh = sinf(D2R * inSettings->heading);
+		float cp = cosf(D2R * inSettings->pitch);
+		float sp = sinf(D2R * inSettings->pitch);
 		inSettings->lookFrom[0][0] -= inSettings->mouseSpeed * sh * cp * inSettings->frameTime;
 		inSettings->lookFrom[0][1] += inSettings->mouseSpeed * sp * inSettings->frameTime;
 		inSettings->lookFrom[0][2] -= inSettings->mouseSpeed * ch * cp * inSettings->frameTime;
@@ -617,24 +689,15 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 
 	// Interpolate fov, heading, and pitch using zoom value
 	// zoom of {0,1} maps to fov of {60,6}
-	const float t(0.5f * (1.0f - cosf(RS_PI * zoom)));
-	gFov = 60.0f - 54.0f * t;
-	heading = zoomHeading * t + heading * (1.0f - t);
-	pitch = zoomPitch * t + pitch * (1.0f - t);
-
-	reshape(inSettings);
-
-	// Build modelview matrix
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	glRotatef(-pitch, 1, 0, 0);
-	glRotatef(-heading, 0, 1, 0);
-	glTranslatef(-(inSettings->lookFrom[0][0]), -(inSettings->lookFrom[0][1]), -(inSettings->lookFrom[0][2]));
-	// get modelview matrix for flares
-	glGetDoublev(GL_MODELVIEW_MATRIX, inSettings->modelMat);
+	const float t(0.5f * (1.0f - cosf(RS_PI * inSettings->zoom)));
+	inSettings->fov = 60.0f - 54.0f * t;
+	inSettings->heading = inSettings->zoomHeading * t + inSettings->heading * (1.0f - t);
+	inSettings->pitch = inSettings->zoomPitch * t + inSettings->pitch * (1.0f - t);
+
+	findHFov(inSettings);
 
 	// store this frame's camera mode for next frame
-	lastCameraMode = inSettings->kCamera;
+	inSettings->lastCameraMode = inSettings->kCamera;
 	// Update mouse idle time
 	/*if(kCamera == 2){
 		mouseIdleTime += frameTime;
@@ -643,93 +706,76 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 	}*/
 
 	// update billboard rotation matrix for particles
-	glPushMatrix();
-	glLoadIdentity();
-	glRotatef(heading, 0, 1, 0);
-	glRotatef(pitch, 1, 0, 0);
-	glGetFloatv(GL_MODELVIEW_MATRIX, inSettings->billboardMat);
-	glPopMatrix();
-
-	// clear the screen
-	glClear(GL_COLOR_BUFFER_BIT);
+	{
+		rsMatrix billboard, pitchMat;
+		billboard.makeRotate(inSettings->heading * D2R, 0.0f, 1.0f, 0.0f);
+		pitchMat.makeRotate(inSettings->pitch * D2R, 1.0f, 0.0f, 0.0f);
+		billboard.preMult(pitchMat);
+		billboard.get(inSettings->billboardMat);
+	}
+	now = simClock();
+	stats.cameraTime = now - clock;
+	clock = now;
 
 	// Slows fireworks, but not camera
 	if(inSettings->kSlowMotion)
 		inSettings->frameTime *= 0.5f;
 
-	// Make more particles if necessary (always keep 1000 extra).
-	// Ordinarily, you would resize as needed during the update loop, probably in the
-	// addParticle() function.  But that logic doesn't work with this particle system
-	// because particles can spawn other particles.  resizing the vector, and, thus, 
-	// moving all particle addresses, doesn't work if you are in the middle of
-	// updating a particle.
-	//const unsigned int size(inSettings->particles.size());
-	if(inSettings->particles.size() - int(inSettings->last_particle) < 1000)
-		inSettings->particles.resize(inSettings->particles.size() + 1000, inSettings);
-
 	// Pause the animation?
 	if(inSettings->kFireworks){
 		// update world
 		inSettings->theWorld->update(inSettings->frameTime, inSettings);
-	
-		// darken smoke
-		static float ambientlight = float(inSettings->dAmbient) * 0.01f;
-		for(unsigned int i=0; i<inSettings->last_particle; ++i){
-			particle* darkener(&(inSettings->particles[i]));
-			if(darkener->type == SMOKE)
-				darkener->rgb[0] = darkener->rgb[1] = darkener->rgb[2] = ambientlight;
-		}
+		now = simClock();
+		stats.worldTime = now - clock;
+		clock = now;
+		const unsigned int beforeLaunch(inSettings->last_particle);
 
 		// Change rocket firing rate
-		static float rocketTimer = 0.0f;
-		// a rocket usually lasts about 10 seconds, so fastest rate is all rockets within 10 seconds
-		static float rocketTimeConst = 10.0f / float(inSettings->dMaxrockets);
-		static float changeRocketTimeConst = 20.0f;
-		changeRocketTimeConst -= inSettings->frameTime;
-		if(changeRocketTimeConst <= 0.0f){
+		inSettings->changeRocketTimeConst -= inSettings->frameTime;
+		if(inSettings->changeRocketTimeConst <= 0.0f){
 			float temp = rsRandf(4.0f);
-			rocketTimeConst = (temp * temp) + (10.0f / float(inSettings->dMaxrockets));
-			changeRocketTimeConst = rsRandf(30.0f) + 10.0f;
+			inSettings->rocketTimeConst = (temp * temp) + (10.0f / float(inSettings->dMaxrockets));
+			inSettings->changeRocketTimeConst = rsRandf(30.0f) + 10.0f;
 		}
 		// add new rocket to list
-		rocketTimer -= inSettings->frameTime;
-		if((rocketTimer <= 0.0f) || (inSettings->userDefinedExplosion >= 0)){
+		inSettings->rocketTimer -= inSettings->frameTime;
+		if((inSettings->dAutoLaunch && inSettings->rocketTimer <= 0.0f) || (inSettings->userDefinedExplosion >= 0)){
 			if(inSettings->numRockets < inSettings->dMaxrockets){
-				particle* rock = addParticle(inSettings);
+				particle rock(addParticle(inSettings));
 				if(rsRandi(30) || (inSettings->userDefinedExplosion >= 0)){  // Usually launch a rocket
-					rock->initRocket(inSettings);
+					rock.initRocket(inSettings);
 					if(inSettings->userDefinedExplosion >= 0)
-						rock->explosiontype = inSettings->userDefinedExplosion;
+						rock.explosiontype = inSettings->userDefinedExplosion;
 					else{
 						if(!rsRandi(2500)){  // big ones!
 							if(rsRandi(2))
-								rock->explosiontype = 19;  // sucker and shockwave
+								rock.explosiontype = 19;  // sucker and shockwave
 							else
-								rock->explosiontype = 20;  // stretcher and bigmama
+								rock.explosiontype = 20;  // stretcher and bigmama
 						}
 						else{
 							// Distribution of regular explosions
 							if(rsRandi(2)){  // 0 - 2 (all types of spheres)
 								if(!rsRandi(10))
-									rock->explosiontype = 2;
+									rock.explosiontype = 2;
 								else
-									rock->explosiontype = rsRandi(2);
+									rock.explosiontype = rsRandi(2);
 							}
 							else{
 								if(!rsRandi(3))  //  ring, double sphere, sphere and ring
-									rock->explosiontype = rsRandi(3) + 3;
+									rock.explosiontype = rsRandi(3) + 3;
 								else{
 									if(rsRandi(2)){  // 6, 7, 8, 9, 10, 11
 										if(rsRandi(2))
-											rock->explosiontype = rsRandi(2) + 6;
+											rock.explosiontype = rsRandi(2) + 6;
 										else
-											rock->explosiontype = rsRandi(4) + 8;
+											rock.explosiontype = rsRandi(4) + 8;
 									}
 									else{
 										if(rsRandi(2))  // 12, 13, 14
-											rock->explosiontype = rsRandi(3) + 12;
+											rock.explosiontype = rsRandi(3) + 12;
 										else  // 15 - 18
-											rock->explosiontype = rsRandi(4) + 15;
+											rock.explosiontype = rsRandi(4) + 15;
 									}
 								}
 							}
@@ -738,248 +784,329 @@ __private_extern__ void draw(SkyrocketSaverSettings * inSettings){
 					inSettings->numRockets++;
 				}
 				else{  // sometimes make fountains instead of rockets
-					rock->initFountain(inSettings);
+					rock.initFountain(inSettings);
 					int num_fountains = rsRandi(3);
 					for(int i=0; i<num_fountains; i++){
-						rock = addParticle(inSettings);
-						rock->initFountain(inSettings);
+						particle fountain(addParticle(inSettings));
+						fountain.initFountain(inSettings);
 					}
 				}
 			}
 			if(inSettings->dMaxrockets)
-				rocketTimer = rsRandf(rocketTimeConst);
+				inSettings->rocketTimer = rsRandf(inSettings->rocketTimeConst);
 			else
-				rocketTimer = 60.0f;  // arbitrary number since no rockets ever fire
+				inSettings->rocketTimer = 60.0f;  // arbitrary number since no rockets ever fire
 			if(inSettings->userDefinedExplosion >= 0){
 				inSettings->userDefinedExplosion = -1;
-				rocketTimer = 20.0f;  // Wait 20 seconds after user launches a rocket before launching any more
+				inSettings->rocketTimer = 20.0f;  // Wait 20 seconds after user launches a rocket before launching any more
 			}
 		}
+		stats.launched = inSettings->last_particle - beforeLaunch;
+		now = simClock();
+		stats.launchTime = now - clock;
+		clock = now;
 
 		// update particles
+		// Each pass updates a range of particles, turns the ones that are done
+		// into whatever comes next, and fills the holes left by dead ones with
+		// survivors from the end of the range.  Children spawned by the pass are
+		// merged into the live set after it and then updated themselves, until no
+		// more new particles appear.
 		inSettings->numRockets = 0;
-		for(unsigned int i=0; i<inSettings->last_particle; i++){
-			particle* curpart(&(inSettings->particles[i]));
-			inSettings->particles[i].update(inSettings);
-			if(curpart->type == ROCKET)
-				inSettings->numRockets++;
-				curpart->findDepth(inSettings);
-			if(curpart->life <= 0.0f || curpart->xyz[1] < 0.0f){
-				switch(curpart->type){
-				case ROCKET:
-					if(curpart->xyz[1] <= 0.0f){
-						// move above ground for explosion so new particles aren't removed
-						curpart->xyz[1] = 0.1f;
-						curpart->vel[1] *= -0.7f;
-					}
-					if(curpart->explosiontype == 18)
-						curpart->initSpinner(inSettings);
-					else
-						curpart->initExplosion(inSettings);
-					break;
-				case POPPER:
-					switch(curpart->explosiontype){
-					case STAR:
-						curpart->explosiontype = 100;
-						curpart->initExplosion(inSettings);
+		inSettings->deferSpawns = 1;
+		particleStore& store(inSettings->particles);
+		const unsigned int zoomRocket(inSettings->zoomRocket);
+		inSettings->zoomRocket = ZOOMROCKETINACTIVE;  // unless it survives
+		unsigned int firstUpdate = 0;
+		bool firstPass = true;
+		while(firstUpdate < inSettings->last_particle){
+			const unsigned int lastUpdate = inSettings->last_particle;
+			updateParticles(firstUpdate, lastUpdate, inSettings);
+			stats.updated += lastUpdate - firstUpdate;
+			unsigned int i = firstUpdate;
+			unsigned int end = lastUpdate;
+			while(i < end){
+				if(!finishUpdate(i, inSettings)){
+					// find the last survivor to take this slot
+					while(--end > i && !finishUpdate(end, inSettings));
+					if(end == i)
 						break;
-					case STREAMER:
-						curpart->explosiontype = 101;
-						curpart->initExplosion(inSettings);
-						break;
-					case METEOR:
-						curpart->explosiontype = 102;
-						curpart->initExplosion(inSettings);
-						break;
-					case POPPER:
-						curpart->type = STAR;
-						curpart->rgb.set(1.0f, 0.8f, 0.6f);
-						curpart->t = inSettings->particles[i].tr = inSettings->particles[i].life = 0.2f;
-					}
-					break;
-				case SUCKER:
-					curpart->initShockwave(inSettings);
-					break;
-				case STRETCHER:
-					curpart->initBigmama(inSettings);
+					store.copy(i, end);
+					if(firstPass && end == zoomRocket)
+						inSettings->zoomRocket = i;
 				}
+				else if(firstPass && i == zoomRocket)
+					inSettings->zoomRocket = i;
+				++i;
 			}
+			inSettings->last_particle = i;
+			firstUpdate = i;
+			firstPass = false;
+			mergeSpawns(inSettings);
 		}
-
-		// remove particles from list
-		for(unsigned int i=0; i<inSettings->last_particle; i++){
-			particle* curpart(&(inSettings->particles[i]));
-			if(curpart->life <= 0.0f || curpart->xyz[1] < 0.0f)
-				removeParticle(i, inSettings);
+		inSettings->deferSpawns = 0;
+		now = simClock();
+		stats.updateTime = now - clock;
+		clock = now;
+
+		// Lights and force fields act on other particles, so they are applied
+		// once everything has been updated.  The grid lets each of them look at
+		// only the particles near it.
+		{
+			const unsigned int* type(store.type);
+			std::vector<unsigned int> interacting;
+			unsigned int queries(0);
+			for(unsigned int i=0; i<inSettings->last_particle; i++){
+				if(type[i] == ROCKET || type[i] == FOUNTAIN || type[i] == EXPLOSION){
+					interacting.push_back(i);
+					if(inSettings->dIllumination)
+						++queries;
+				}
+				else if(type[i] == SUCKER || type[i] == SHOCKWAVE || type[i] == STRETCHER){
+					interacting.push_back(i);
+					++queries;
+				}
+			}
+			inSettings->grid.build(store, inSettings->last_particle, queries);
+			inSettings->smokeLights.clear();
+			inSettings->forces.clear();
+			for(unsigned int n=0; n<interacting.size(); n++)
+				particle(store, interacting[n]).interact(inSettings);
+			// every particle gathers all the force fields that reach it in one pass
+			inSettings->forces.apply(store, inSettings->grid, inSettings->workers);
+			// smoke gets ambient light plus whatever lights were added
+			inSettings->smokeLights.shine(store, inSettings->grid, float(inSettings->dAmbient) * 0.01f, inSettings->workers);
+			if(inSettings->dClouds)
+				inSettings->theWorld->lightClouds();
 		}
 
-		sortParticles();
+		stats.interactTime = simClock() - clock;
 	}  // kFireworks
 
 	else{
-		// Only sort particles if they're not being updated (the camera could still be moving)
+		// Only find depths if particles aren't being updated (the camera could still be moving)
 		for(unsigned int i=0; i<inSettings->last_particle; i++)
-			inSettings->particles[i].findDepth(inSettings);
-		sortParticles();
+			particle(inSettings->particles, i).findDepth(inSettings);
+		stats.updateTime = simClock() - clock;
 	}
+}
 
-	// measure compute time
-	//computeTime += computeTimer.tick();
-	// start draw time timer
-	//drawTimer.tick();
-
-	// the world
-	inSettings->theWorld->draw(inSettings);
-
-	// draw particles
-	glEnable(GL_BLEND);
-	for(unsigned int i=0; i<inSettings->last_particle; i++)
-		inSettings->particles[i].draw(inSettings);
-
-	// draw lens flares
-	if(inSettings->dFlare){
-		makeFlareList(inSettings);
-		for(unsigned int i=0; i<inSettings->numFlares; ++i){
-			flare(inSettings->lensFlares[i].x, inSettings->lensFlares[i].y, inSettings->lensFlares[i].r,
-				inSettings->lensFlares[i].g, inSettings->lensFlares[i].b, inSettings->lensFlares[i].a, inSettings);
-		}
-		inSettings->numFlares = 0;
-	}
 
-	// measure draw time
-	//drawTime += drawTimer.tick();
-
-	// do sound stuff
-	if(soundengine){
-		float listenerOri[6];
-		listenerOri[0] = float(-(inSettings->modelMat[2]));
-		listenerOri[1] = float(-(inSettings->modelMat[6]));
-		listenerOri[2] = float(-(inSettings->modelMat[10]));
-		listenerOri[3] = float(inSettings->modelMat[1]);
-		listenerOri[4] = float(inSettings->modelMat[5]);
-		listenerOri[5] = float(inSettings->modelMat[9]);
-		soundengine->update(inSettings->cameraPos.v, inSettings->cameraVel.v, listenerOri, inSettings->frameTime, inSettings->kSlowMotion);
-	}
+// Most show time that one stepSim() will simulate.  If the computer can't keep up,
+// the show slows down rather than falling further and further behind.
+#define MAXSTEPTIME 0.25f
 
-	//draw_overlay(frameTime);
-
-	// print text
-	static float totalTime = 0.0f;
-	totalTime += inSettings->frameTime;
-	static std::vector<std::string> strvec;
-	static int frames = 0;
-	++frames;
-	if(frames == 20){
-		strvec.clear();
-		std::string str1 = "         FPS = " + to_string(20.0f / totalTime);
-		strvec.push_back(str1);
-		std::string str2 = "compute time = " + to_string(computeTime / 20.0f);
-		strvec.push_back(str2);
-		std::string str3 = "   draw time = " + to_string(drawTime / 20.0f);
-		strvec.push_back(str3);
-		totalTime = 0.0f;
-		computeTime = 0.0f;
-		drawTime = 0.0f;
-		frames = 0;
-	}
+// Remember the camera so the renderer can move smoothly from here to the next tick
+static void saveLastCamera(SkyrocketSaverSettings *inSettings){
+	inSettings->lastLookFrom = inSettings->lookFrom[0];
+	inSettings->lastHeading = inSettings->heading;
+	inSettings->lastPitch = inSettings->pitch;
+	inSettings->lastFov = inSettings->fov;
+}
 
-	if(inSettings->kStatistics){
-		glMatrixMode(GL_PROJECTION);
-		glPushMatrix();
-		glLoadIdentity();
-		glOrtho(0.0f, 50.0f * inSettings->aspectRatio, 0.0f, 50.0f, -1.0f, 1.0f);
+int stepSim(float elapsed, SkyrocketSaverSettings *inSettings){
+	if(!inSettings->dSimRate){
+		inSettings->frameTime = elapsed;
+		updateSim(inSettings);
+		inSettings->tickFraction = 1.0f;
+		return 1;
+	}
 
-		glMatrixMode(GL_MODELVIEW);
-		glPushMatrix();
-		glLoadIdentity();
-		glTranslatef(1.0f, 48.0f, 0.0f);
+	const float tick(1.0f / float(inSettings->dSimRate));
+	// super fast easter egg
+	if(inSettings->superFast)
+		elapsed *= 5.0f;
+	inSettings->tickTime += elapsed;
+	if(inSettings->tickTime > MAXSTEPTIME)
+		inSettings->tickTime = MAXSTEPTIME;
+	// there's nothing to draw until the camera has been placed by one tick
+	if(inSettings->first && inSettings->tickTime < tick)
+		inSettings->tickTime = tick;
+
+	std::vector<soundEvent> sounds;
+	simStats stats = simStats();
+	float showTime(0.0f);
+	int ticks(0);
+	while(inSettings->tickTime >= tick){
+		const int cut(inSettings->first || inSettings->kNewCamera);
+		saveLastCamera(inSettings);
+		inSettings->frameTime = tick;
+		updateSim(inSettings);
+		if(cut)  // don't swing the camera across a cut to a new view
+			saveLastCamera(inSettings);
+		inSettings->tickTime -= tick;
+		showTime += inSettings->frameTime;
+		++ticks;
+
+		sounds.insert(sounds.end(), inSettings->soundEvents.begin(), inSettings->soundEvents.end());
+		stats.launched += inSettings->stats.launched;
+		stats.updated += inSettings->stats.updated;
+		stats.spawned += inSettings->stats.spawned;
+		stats.cameraTime += inSettings->stats.cameraTime;
+		stats.worldTime += inSettings->stats.worldTime;
+		stats.launchTime += inSettings->stats.launchTime;
+		stats.updateTime += inSettings->stats.updateTime;
+		stats.interactTime += inSettings->stats.interactTime;
+	}
+	inSettings->soundEvents.swap(sounds);
+	inSettings->stats = stats;
+	inSettings->frameTime = showTime;
+	inSettings->tickFraction = inSettings->tickTime / tick;
+	return ticks;
+}
 
-		glColor3f(1.0f, 0.6f, 0.0f);
-		inSettings->textwriter->draw(strvec);
 
-		glPopMatrix();
-		glMatrixMode(GL_PROJECTION);
-		glPopMatrix();
+void viewMatrices(SkyrocketSaverSettings *inSettings){
+	rsVec eye(inSettings->lookFrom[0]);
+	float heading(inSettings->heading);
+	float pitch(inSettings->pitch);
+	float fov(inSettings->fov);
+	const float t(inSettings->tickFraction);
+	if(t < 1.0f){
+		eye = inSettings->lastLookFrom + (eye - inSettings->lastLookFrom) * t;
+		float dh(heading - inSettings->lastHeading);
+		if(dh > 180.0f)
+			dh -= 360.0f;
+		if(dh < -180.0f)
+			dh += 360.0f;
+		heading = inSettings->lastHeading + dh * t;
+		pitch = inSettings->lastPitch + (pitch - inSettings->lastPitch) * t;
+		fov = inSettings->lastFov + (fov - inSettings->lastFov) * t;
 	}
 
-	//wglSwapLayerBuffers(hdc, WGL_SWAP_MAIN_PLANE);
+	// fov is vertical unless the window is taller than it is wide
+	rsMatrix mat;
+	if(inSettings->aspectRatio > 1.0f)
+		mat.makePerspective(fov * D2R, inSettings->aspectRatio, 1.0f, 40000.0f);
+	else
+		mat.makePerspective(2.0f * atanf(tanf(fov * 0.5f * D2R) / inSettings->aspectRatio),
+			inSettings->aspectRatio, 1.0f, 40000.0f);
+	for(int i=0; i<16; ++i)
+		inSettings->projMat[i] = mat[i];
+
+	// same as glRotatef(-pitch, 1, 0, 0), glRotatef(-heading, 0, 1, 0), then
+	// glTranslatef(-eye)
+	rsMatrix headingMat, eyeMat;
+	mat.makeRotate(-pitch * D2R, 1.0f, 0.0f, 0.0f);
+	headingMat.makeRotate(-heading * D2R, 0.0f, 1.0f, 0.0f);
+	mat.preMult(headingMat);
+	eyeMat.makeTranslate(-eye[0], -eye[1], -eye[2]);
+	mat.preMult(eyeMat);
+	for(int i=0; i<16; ++i)
+		inSettings->modelMat[i] = mat[i];
 }
 
 
-/*void IdleProc(){
-	// update time
-	static rsTimer timer;
-	frameTime = timer.tick();
+// Allocate a particle store for the show, settling for a smaller one if there
+// isn't enough memory.  Returns the capacity actually allocated, which callers
+// must use in place of size.
+static unsigned int reserveParticles(particleStore &store, unsigned int size, const char* what, SkyrocketSaverSettings *inSettings){
+	const unsigned int wanted(size);
+	while(!store.resize(size, inSettings)){
+		// Not even one slot, not even the scratch slot addParticle() needs.
+		// That's as out of memory as a failed new.
+		if(size <= 1)
+			throw std::bad_alloc();
+		size /= 2;
+	}
+	if(store.capacity < wanted)
+		fprintf(stderr, "Skyrocket: only room for %u of %u %s\n", store.capacity, wanted, what);
+	return store.capacity;
+}
 
-	if(readyToDraw && !isSuspended && !checkingPassword)
-		draw();
-    glFlush();
-	//wglSwapLayerBuffers(hdc, WGL_SWAP_MAIN_PLANE);
-}*/
 
+void resizeSim(int width, int height, SkyrocketSaverSettings *inSettings){
+	inSettings->xsize = width;
+	inSettings->ysize = height;
+	inSettings->centerx = inSettings->xsize / 2;
+	inSettings->centery = inSettings->ysize / 2;
+	inSettings->viewport[0] = 0;
+	inSettings->viewport[1] = 0;
+	inSettings->viewport[2] = width;
+	inSettings->viewport[3] = height;
+	inSettings->aspectRatio = float(width) / float(height);
+	findHFov(inSettings);
+}
 
-void initSaver(int width, int height,SkyrocketSaverSettings * inSettings){
-	//RECT rect;
 
+void initSim(int width, int height, SkyrocketSaverSettings *inSettings){
 	// Initialize pseudorandom number generator
-	srand((unsigned)time(NULL));
+	inSettings->seed = inSettings->dSeed ? inSettings->dSeed : (unsigned int)time(NULL);
+	inSettings->random.seed(inSettings->seed);
+	rsCurrentRandom = &inSettings->random;
 	
 	// NZ: Set up defaults in inSettings:
 	inSettings->readyToDraw = 0;
 	inSettings->lookAt[0] = rsVec(0.0f, 1000.0f, 0.0f);
 	inSettings->lookAt[1] = rsVec(0.0f, 1000.0f, 0.0f);
 	inSettings->lookAt[2] = rsVec(0.0f, 1000.0f, 0.0f);
-	//inSettings->soundengine = NULL;
 	inSettings->numRockets = 0;
-	inSettings->numFlares = 0;
 	inSettings->kFireworks = 1;
 	inSettings->kNewCamera = 0;
 	inSettings->userDefinedExplosion = -1;
 	inSettings->zoomRocket = ZOOMROCKETINACTIVE;
 	inSettings->first = 1;
-
-	// Window initialization
-	//hdc = GetDC(hwnd);
-	//SetBestPixelFormat(hdc);
-	//hglrc = wglCreateContext(hdc);
-	//GetClientRect(hwnd, &rect);
-	//wglMakeCurrent(hdc, hglrc);
-	//xsize = rect.right - rect.left;
-	//ysize = rect.bottom - rect.top;
-	inSettings->xsize = width;
-	inSettings->ysize = height;
-	inSettings->centerx = inSettings->xsize / 2;
-	inSettings->centery = inSettings->ysize / 2;
-	glViewport(0, 0, inSettings->xsize, inSettings->ysize);
-	glGetIntegerv(GL_VIEWPORT, inSettings->viewport);
-	inSettings->aspectRatio = float(width) / float(height);
-
-	/*glViewport(0, 0, rect.right, rect.bottom);
-	aspectRatio = float(rect.right) / float(rect.bottom);*/
-	gFov = 60.0;
-	reshape(inSettings);
-
-	// Set OpenGL state
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glDisable(GL_DEPTH_TEST);
-	glEnable(GL_TEXTURE_2D);
-	glFrontFace(GL_CCW);
-	glEnable(GL_CULL_FACE);
+	inSettings->last_particle = 0;
+	inSettings->deferSpawns = 0;
+	inSettings->droppedParticles = 0;
+	inSettings->soundEvents.clear();
+
+	// camera
+	inSettings->lastCameraMode = inSettings->kCamera;
+	inSettings->cameraTime[0] = 20.0f;
+	inSettings->cameraTime[1] = 0.0f;
+	inSettings->cameraTime[2] = 0.0f;
+	inSettings->zoom = 0.0f;
+	inSettings->zoomTime[0] = 300.0f;
+	inSettings->zoomTime[1] = 0.0f;
+	inSettings->heading = 0.0f;
+	inSettings->pitch = 0.0f;
+	inSettings->zoomHeading = 0.0f;
+	inSettings->zoomPitch = 0.0f;
+	inSettings->superFast = 0;
+
+	// rocket firing rate
+	inSettings->rocketTimer = 0.0f;
+	// a rocket usually lasts about 10 seconds, so fastest rate is all rockets within 10 seconds
+	inSettings->rocketTimeConst = 10.0f / float(inSettings->dMaxrockets);
+	inSettings->changeRocketTimeConst = 20.0f;
+
+	inSettings->fov = 60.0f;
+	resizeSim(width, height, inSettings);
+	inSettings->tickTime = 0.0f;
+	inSettings->tickFraction = 1.0f;
 
 	// Initialize data structures
-	initFlares(inSettings);
-	//initRockets();
+	// Reserve all particle memory now so it never has to move during a show
+	if(inSettings->dMaxParticles < 1000)
+		inSettings->dMaxParticles = 1000;
+	inSettings->dMaxParticles = reserveParticles(inSettings->particles, inSettings->dMaxParticles, "particles", inSettings);
+	chooseKinematics(inSettings->dSimd);
+	// The main thread's queue also takes everything spawned by explosions,
+	// so it gets a bigger share.
+	unsigned int numThreads = inSettings->dThreads;
+	if(inSettings->dThreads <= 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads < 1)
+		numThreads = 1;
+	inSettings->workers = new workerPool(numThreads);
+	// Every chunk of particles gets its own stream, derived from the same seed
+	inSettings->updateStreams.resize(inSettings->particles.capacity / UPDATECHUNK + 1);
+	for(unsigned int i=0; i<inSettings->updateStreams.size(); ++i)
+		inSettings->updateStreams[i].random.seed((uint64_t(i + 1) << 32) + inSettings->seed);
+	inSettings->someSmoke = 0;
+	for(unsigned int i=0; i<numThreads; ++i){
+		spawnQueue* queue = new spawnQueue;
+		if(i == 0)
+			reserveParticles(queue->store, inSettings->dMaxParticles / 4 + 1, "spawns", inSettings);
+		else
+			reserveParticles(queue->store, inSettings->dMaxParticles / 4 / numThreads + 1000, "spawns", inSettings);
+		inSettings->spawnQueues.push_back(queue);
+	}
 	if(inSettings->dSmoke)
-		initSmoke(inSettings);
+		initSmokeTimes(inSettings);
 	inSettings->theWorld = new World(inSettings);
-	initShockwave();
-	if(inSettings->dSound && soundengine == NULL)
-		soundengine = new SoundEngine(float(inSettings->dSound) * 0.01f);
-
-	//init_overlay();
 
-	//outfile.open("outfile");
-	
 	// Addition by NZ: If we're using a static camera, then randomize the camera.
 	if (inSettings->kCamera == 0)
 	{
@@ -987,6 +1114,30 @@ void initSaver(int width, int height,SkyrocketSaverSettings * inSettings){
 	}
 }
 
+
+void cleanupSim(SkyrocketSaverSettings *inSettings){
+	// Free memory
+	inSettings->particles.clear();
+	inSettings->last_particle = 0;
+	for(unsigned int i=0; i<inSettings->spawnQueues.size(); ++i)
+		delete inSettings->spawnQueues[i];
+	inSettings->spawnQueues.clear();
+	inSettings->updateStreams.clear();
+	delete inSettings->workers;
+	inSettings->workers = NULL;
+	delete inSettings->theWorld;
+	inSettings->theWorld = NULL;
+	inSettings->soundEvents.clear();
+	stopShowLog(inSettings);
+}
+
+
+// Launch a rocket with this type of explosion, like the number keys do
+void requestExplosion(int explosion, SkyrocketSaverSettings *inSettings){
+	logExplosion(explosion, inSettings);
+	inSettings->userDefinedExplosion = explosion;
+}
+
 __private_extern__ void setDefaults(SkyrocketSaverSettings * inSettings)
 {
 	inSettings->dMaxrockets = 8;
@@ -1004,30 +1155,21 @@ __private_extern__ void setDefaults(SkyrocketSaverSettings * inSettings)
 	inSettings->dEarth = 1;
 	inSettings->dIllumination = 1;
 	inSettings->kSlowMotion = false;
+	inSettings->dMaxParticles = 100000;
+	inSettings->dThreads = 0;
+	inSettings->dSimd = 1;
+	inSettings->dSeed = 0;
+	inSettings->dAutoLaunch = 1;
+	inSettings->dSimRate = 0;
+	inSettings->dSmokeBlend = SMOKEBLEND_SORT;
+	inSettings->dMaxFlares = 32;
+	inSettings->dFlareStyle = FLARESTYLE_SPRITES;
 }
 
-__private_extern__ void cleanup(SkyrocketSaverSettings * inSettings)
-{
-	// Free memory
-	inSettings->particles.clear();
-	
-	// clean up sound data structures
-	if(inSettings->dSound)
-	{
-		delete soundengine;
-		soundengine = NULL;
-	}
-	
-	// Kill device context
-	/*ReleaseDC(hwnd, hdc);
-	wglMakeCurrent(NULL, NULL);
-	wglDeleteContext(hglrc);*/
-}
-
-
 //LONG ScreenSaverProc(HWND hwnd, UINT msg, WPARAM wpm, LPARAM lpm){
 long ScreenSaverProc(unsigned int msg, unsigned int wpm, unsigned long lpm, SkyrocketSaverSettings *inSettings)
 {
+	logInput(msg, wpm, lpm, inSettings);
 	switch(msg){
 		/*case WM_CREATE:
 			readRegistry();
@@ -3,22 +3,43 @@
 
 #include "flare.h"
 #include "rsMath.h"
-#include "rsText.h"
 #include "smoke.h"
-#include "SoundEngine.h"
-#include <OpenGL/gl.h>
+#include "soundevents.h"
+#include <sys/types.h>
+#include <vector>
 #ifndef PARTICLE_H
 #include "particle.h"
 #endif
+#include "particlegrid.h"
+#include "smokelight.h"
+#include "forcefield.h"
+#include "depthsort.h"
+#include "frustum.h"
+#include "flarelights.h"
+
+// Apple's linkage keyword; the simulation also builds elsewhere (CMakeLists.txt)
+#ifndef __APPLE__
+#define __private_extern__
+#endif
 
 #define PI 3.14159265359f
 #define PIx2 6.28318530718f
 #define D2R 0.0174532925f
 #define R2D 57.2957795131f
-#define MAXFLARES 110    // Required 100 and 10 extra for good measure
 #define MINDEPTH -1000000.0f  // particle depth for inactive particles
 
 class World;
+class workerPool;
+class rsText;
+class showLog;
+
+// What the last updateSim() did, and how long each part of it took in seconds
+struct simStats{
+	unsigned int launched;  // rockets and fountains
+	unsigned int updated;  // particle updates, counting children updated in the same frame
+	unsigned int spawned;  // particles added by other particles
+	double cameraTime, worldTime, launchTime, updateTime, interactTime;
+};
 //class particle;
 
 typedef struct SkyrocketSaverSettings
@@ -36,6 +57,16 @@ typedef struct SkyrocketSaverSettings
 		rsVec(0.0f, 1000.0f, 0.0f)}*/;
 	rsVec cameraPos;  // used for positioning sounds (same as lookFrom[0])
 	rsVec cameraVel;  // used for doppler shift
+	int lastCameraMode;  // kCamera last frame
+	float cameraTime[3];  // time, elapsed time, step (1.0 - 0.0)
+	float zoom;  // For interpolating from regular camera view to zoomed in view
+	float zoomTime[2];  // time until next zoom, duration of zoom
+	float heading, pitch;
+	float zoomHeading, zoomPitch;
+	float fov, hFov;  // vertical and horizontal field of view in degrees
+	// camera as of the tick before the latest one, for drawing in between ticks (see stepSim())
+	rsVec lastLookFrom;
+	float lastHeading, lastPitch, lastFov;
 					  // Mouse variables
 	float mouseIdleTime;
 	int mouseButtons, mousex, mousey;
@@ -44,11 +75,9 @@ typedef struct SkyrocketSaverSettings
 	// the sound engine
 	//SoundEngine* soundengine/* = NULL*/;
 	
-	// flare display lists
-	unsigned int flarelist[4];
-	// matrix junk for drawing flares in screen space
+	// matrix junk for drawing flares in screen space (see viewMatrices())
 	double modelMat[16], projMat[16];
-	GLint viewport[4];
+	int viewport[4];
 	
 	// transformation needed for rendering particles
 	float billboardMat[16];
@@ -56,8 +85,6 @@ typedef struct SkyrocketSaverSettings
 	// lifespans for smoke particles
 	float smokeTime[SMOKETIMES];  // lifespans of consecutive smoke particles
 	int whichSmoke[WHICHSMOKES];  // table to indicate which particles produce smoke
-								  // smoke display lists
-	unsigned int smokelist[5];
 	
 	// the world
 	World* theWorld;
@@ -67,8 +94,11 @@ typedef struct SkyrocketSaverSettings
 	
 	
 	int numRockets /*= 0*/;
-	std::vector<flareData> lensFlares;
-	unsigned int numFlares /*= 0*/;
+	float rocketTimer;  // time until next launch
+	float rocketTimeConst;  // launches are up to this far apart
+	float changeRocketTimeConst;  // time until rocketTimeConst changes
+	int superFast;  // easter egg:  everything runs at 5x speed
+	flareLights lensFlares;  // lens flares for the frame being drawn
 	// Parameters edited in the dialog box
     int dMaxrockets;
     int dSmoke;
@@ -96,17 +126,77 @@ typedef struct SkyrocketSaverSettings
     float frameTime;
 	int first;
 	
-	std::vector<particle> particles;
+	particleStore particles;
 	unsigned int last_particle/* = 0*/;
+	// Particles spawned while the others are being updated wait in these
+	// and are merged into the live set afterwards.  See addParticle().
+	// There is one queue per update thread; the main thread uses the first.
+	std::vector<spawnQueue*> spawnQueues;
+	std::vector<updateStream> updateStreams;  // one per chunk of particles (see updateParticles())
+	int someSmoke;  // which entry of whichSmoke the next star made outside the update pass uses
+	int deferSpawns;
+	particleGrid grid;  // where particles are, for lights and force fields (see particle::interact())
+	smokeLighting smokeLights;  // lights shining on smoke this frame
+	forceFields forces;  // suckers, shockwaves, and stretchers acting this frame
+	depthSort smokeOrder;  // order to draw smoke in, farthest first (see draw())
+	frustumCull onScreen;  // particles in view of the camera this frame (see draw())
+	workerPool* workers;  // threads for updating particles
+	int dThreads;  // number of update threads; 0 = one per processor
+	int dMaxParticles;  // number of live particles to make room for at startup
+	int dSimd;  // use SSE/AVX/NEON for particle movement if the CPU has it
+	unsigned int droppedParticles;  // spawns lost because there was no room for them
+	// Random numbers for everything that isn't done by the update threads.
+	// Each spawnQueue has its own stream for its thread.
+	rsRandom random;
+	unsigned int dSeed;  // 0 = seed from the clock
+	int dAutoLaunch;  // 0 = only launch rockets that are asked for (userDefinedExplosion)
+	int dSimRate;  // simulation ticks per second; 0 = one update per frame, however long
+#define SMOKEBLEND_SORT 0  // draw smoke back to front (see depthSort)
+#define SMOKEBLEND_WEIGHTED 1  // weighted blended transparency, no sorting (see oit.h)
+	int dSmokeBlend;  // how overlapping smoke is composited
+	int dMaxFlares;  // most lens flares drawn at once, brightest first; 0 = no limit
+#define FLARESTYLE_SPRITES 0  // a set of flare sprites for each light (see flareLights)
+#define FLARESTYLE_SCREEN 1  // a post process over the glow (see lensflare.h)
+	int dFlareStyle;  // how lens flares are drawn
+	float tickTime;  // show time saved up toward the next tick
+	float tickFraction;  // how far from the last tick toward the next one the display is (0 - 1)
+	unsigned int seed;  // seed actually used for this show
+	// Sounds made during the last updateSim(), for the SoundEngine to play
+	std::vector<soundEvent> soundEvents;
+	simStats stats;
+	showLog* log;  // show being recorded or replayed (showlog.h), or NULL
 #define ZOOMROCKETINACTIVE 1000000000
 	unsigned int zoomRocket/* = ZOOMROCKETINACTIVE*/;
 } SkyrocketSaverSettings;
 
 
+// The simulation (Skyrocket.cpp) needs no OpenGL context.  initSim() starts a
+// show, updateSim() advances it by frameTime, and cleanupSim() frees it.
+void initSim(int width, int height, SkyrocketSaverSettings *inSettings);
+// The window is now width by height
+void resizeSim(int width, int height, SkyrocketSaverSettings *inSettings);
+void updateSim(SkyrocketSaverSettings *inSettings);
+void cleanupSim(SkyrocketSaverSettings *inSettings);
+// Advance the show by elapsed seconds.  With dSimRate set, the show moves in
+// ticks of exactly 1/dSimRate seconds and time left over waits for the next call.
+// Otherwise this is one updateSim() of elapsed.  Afterwards frameTime is the show
+// time that went by, and stats and soundEvents cover every tick.
+int stepSim(float elapsed, SkyrocketSaverSettings *inSettings);
+// Fill projMat and modelMat for the camera part way between the last two
+// ticks, as tickFraction says.  This is all done on the CPU, so draw() only
+// has to load the matrices, and it works without OpenGL.
+void viewMatrices(SkyrocketSaverSettings *inSettings);
+// Launch a rocket with this explosion type next frame.  Same as setting
+// userDefinedExplosion, except that it gets recorded in show logs.
+void requestExplosion(int explosion, SkyrocketSaverSettings *inSettings);
+
+// The screensaver (render.cpp) wraps these with OpenGL and sound
 __private_extern__ void draw(SkyrocketSaverSettings * inSettings);
 
 __private_extern__ void initSaver(int width,int height,SkyrocketSaverSettings * inSettings);
 
+__private_extern__ void reshape(int width,int height,SkyrocketSaverSettings * inSettings);
+
 __private_extern__ void setDefaults(SkyrocketSaverSettings * inSettings);
 
 __private_extern__ void cleanup(SkyrocketSaverSettings * inSettings);
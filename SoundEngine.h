@@ -34,6 +34,7 @@
 #include "alut.h"
 #include <OpenAL/MacOSX_OALExtensions.h>
 #include "rsMath.h"
+#include "soundevents.h"
 #include <math.h>
 
 
@@ -41,16 +42,7 @@
 #define NUM_SOURCES 16  // 16 is the maximum that works on my computer
 #define NUM_BUFFERS 10
 
-#define LAUNCH1SOUND 0
-#define LAUNCH2SOUND 1
-#define BOOM1SOUND 2
-#define BOOM2SOUND 3
-#define BOOM3SOUND 4
-#define BOOM4SOUND 5
-#define POPPERSOUND 6
-#define SUCKSOUND 7
-#define NUKESOUND 8
-#define WHISTLESOUND 9
+// sound numbers are in soundevents.h
 
 
 
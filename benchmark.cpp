@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// Skyrocket simulation benchmark
+//
+// Runs fixed-seed scenarios through the headless simulation and prints what
+// they cost as JSON, so that results from two builds can be diffed.  Each
+// scenario launches a number of rockets of one explosion type (as if typed on
+// the keyboard) and then lets the show run for a fixed number of seconds at a
+// fixed frameTime.  With -simrate the simulation ticks at that rate no matter
+// what the frameTime is (see stepSim()).  Ordering smoke for drawing is part of
+// drawing, so skyrocket_smokebench times it along with the drawing itself.
+//
+// usage:  skyrocket_bench [-seconds s] [-frametime t] [-simrate hz] [-threads n] [-seed n]
+//                         [-maxparticles n] [-simd 0|1] [-record file] [scenario ...]
+//         skyrocket_bench -replay file
+// With no scenario names, every scenario is run.  -record saves one scenario as
+// a show log (showlog.h) and -replay runs a show log instead of a scenario, so
+// two builds can be compared on exactly the same show.  particleHash tells
+// whether two runs ended with exactly the same particles; it doesn't depend
+// on -threads.
+
+
+#include "Skyrocket.h"
+#include "kinematics.h"
+#include "showlog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+
+struct scenario{
+	const char* name;
+	int explosion;  // userDefinedExplosion for every rocket; -1 = the regular show
+	int rockets;  // rockets to launch, one per frame
+};
+
+
+static const scenario scenarios[] = {
+	{"sphere", 0, 8},
+	{"splitsphere", 1, 8},
+	{"multicolorsphere", 2, 8},
+	{"ring", 3, 8},
+	{"doublesphere", 4, 8},
+	{"sphereandring", 5, 8},
+	{"streamers", 6, 8},
+	{"meteors", 7, 8},
+	{"starsandstreamers", 8, 8},
+	{"starsandmeteors", 9, 8},
+	{"streamersinstars", 10, 8},
+	{"meteorsinstars", 11, 8},
+	{"starpoppers", 12, 8},
+	{"streamerpoppers", 13, 8},
+	{"meteorpoppers", 14, 8},
+	{"littlepoppers", 15, 8},
+	{"bees", 16, 8},
+	{"boom", 17, 8},
+	{"spinner", 18, 8},
+	{"suckerandshockwave", 19, 1},
+	{"stretcherandbigmama", 20, 1},
+	{"popperstars", 100, 8},
+	{"popperstreamers", 101, 8},
+	{"poppermeteors", 102, 8},
+	{"show", -1, 0}
+};
+#define NUMSCENARIOS (sizeof(scenarios) / sizeof(scenario))
+
+
+struct benchOptions{
+	float seconds;
+	float frameTime;
+	int simRate;
+	int threads;
+	unsigned int seed;
+	int maxParticles;
+	int simd;
+	const char* record;
+	const char* replay;
+};
+
+
+// FNV-1a hash of the live particles
+static unsigned long long hashParticles(SkyrocketSaverSettings *inSettings){
+	const particleStore& store(inSettings->particles);
+	const unsigned int stride(store.capacity);
+	unsigned long long hash(14695981039346656037ULL);
+	for(unsigned int i=0; i<inSettings->last_particle; ++i){
+		const float values[11] = {store.xyz[i], store.xyz[i + stride], store.xyz[i + stride + stride],
+			store.vel[i], store.vel[i + stride], store.vel[i + stride + stride],
+			store.rgb[i], store.rgb[i + stride], store.rgb[i + stride + stride],
+			store.life[i], float(store.type[i])};
+		const unsigned char* bytes((const unsigned char*)values);
+		for(unsigned int j=0; j<sizeof(values); ++j){
+			hash ^= bytes[j];
+			hash *= 1099511628211ULL;
+		}
+	}
+	return hash;
+}
+
+
+static double benchClock(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Run one scenario (or replay a show log if scen is NULL) and print its JSON object
+static void runScenario(const scenario* scen, const benchOptions &options, bool last){
+	SkyrocketSaverSettings* settings = new SkyrocketSaverSettings();
+	setDefaults(settings);
+	int width(1280), height(720);
+	if(scen){
+		settings->dSeed = options.seed;
+		settings->dThreads = options.threads;
+		settings->dMaxParticles = options.maxParticles;
+		settings->dSimd = options.simd;
+		settings->dSimRate = options.simRate;
+		settings->dSound = 100;  // so that sound events get made
+		if(scen->explosion >= 0){
+			// only the scenario's rockets get launched
+			settings->dMaxrockets = scen->rockets;
+			settings->dAutoLaunch = 0;
+		}
+	}
+	else if(!startReplay(options.replay, width, height, settings)){
+		fprintf(stderr, "skyrocket_bench: can't replay %s\n", options.replay);
+		exit(1);
+	}
+	initSim(width, height, settings);
+	if(options.record && !startRecording(options.record, settings)){
+		fprintf(stderr, "skyrocket_bench: can't record to %s\n", options.record);
+		exit(1);
+	}
+
+	const int frames(scen ? int(options.seconds / options.frameTime + 0.5f) : 0);
+	int launched(0), frame(0);
+	unsigned int peak(0), sounds(0);
+	unsigned long long updated(0), spawned(0), rockets(0);
+	simStats total = simStats();
+	const double start(benchClock());
+	while(scen ? frame < frames : replayFrame(settings)){
+		if(scen){
+			if(launched < scen->rockets){
+				requestExplosion(scen->explosion, settings);
+				++launched;
+			}
+			stepSim(options.frameTime, settings);
+		}
+		else
+			updateSim(settings);
+		++frame;
+
+		const simStats& stats(settings->stats);
+		rockets += stats.launched;
+		updated += stats.updated;
+		spawned += stats.spawned;
+		total.cameraTime += stats.cameraTime;
+		total.worldTime += stats.worldTime;
+		total.launchTime += stats.launchTime;
+		total.updateTime += stats.updateTime;
+		total.interactTime += stats.interactTime;
+		sounds += settings->soundEvents.size();
+		if(settings->last_particle > peak)
+			peak = settings->last_particle;
+	}
+	const double elapsed(benchClock() - start);
+
+	printf("    {\n");
+	if(scen){
+		printf("      \"name\": \"%s\",\n", scen->name);
+		printf("      \"explosion\": %d,\n", scen->explosion);
+		printf("      \"rockets\": %d,\n", scen->rockets);
+	}
+	else
+		printf("      \"replay\": \"%s\",\n", options.replay);
+	printf("      \"seed\": %u,\n", settings->seed);
+	printf("      \"frames\": %d,\n", frame);
+	printf("      \"launched\": %llu,\n", rockets);
+	printf("      \"peakParticles\": %u,\n", peak);
+	printf("      \"finalParticles\": %u,\n", settings->last_particle);
+	printf("      \"particleUpdates\": %llu,\n", updated);
+	printf("      \"spawned\": %llu,\n", spawned);
+	printf("      \"dropped\": %u,\n", settings->droppedParticles);
+	printf("      \"soundEvents\": %u,\n", sounds);
+	printf("      \"particleHash\": \"%016llx\",\n", hashParticles(settings));
+	printf("      \"nsPerParticleUpdate\": %.3f,\n", updated ? total.updateTime * 1.0e9 / double(updated) : 0.0);
+	printf("      \"seconds\": {\n");
+	printf("        \"camera\": %.6f,\n", total.cameraTime);
+	printf("        \"world\": %.6f,\n", total.worldTime);
+	printf("        \"launch\": %.6f,\n", total.launchTime);
+	printf("        \"update\": %.6f,\n", total.updateTime);
+	printf("        \"interact\": %.6f,\n", total.interactTime);
+	printf("        \"total\": %.6f\n", elapsed);
+	printf("      }\n");
+	printf("    }%s\n", last ? "" : ",");
+	fflush(stdout);
+
+	cleanupSim(settings);
+	delete settings;
+}
+
+
+static void usage(){
+	fprintf(stderr, "usage: skyrocket_bench [-seconds s] [-frametime t] [-simrate hz] [-threads n] [-seed n]\n"
+		"                       [-maxparticles n] [-simd 0|1] [-record file] [scenario ...]\n"
+		"       skyrocket_bench -replay file\n"
+		"scenarios:");
+	for(unsigned int i=0; i<NUMSCENARIOS; ++i)
+		fprintf(stderr, " %s", scenarios[i].name);
+	fprintf(stderr, "\n");
+	exit(1);
+}
+
+
+int main(int argc, char** argv){
+	benchOptions options;
+	options.seconds = 20.0f;
+	options.frameTime = 1.0f / 60.0f;
+	options.simRate = 0;
+	options.threads = 0;
+	options.seed = 1;
+	options.maxParticles = 100000;
+	options.simd = 1;
+	options.record = NULL;
+	options.replay = NULL;
+
+	std::vector<const scenario*> torun;
+	for(int i=1; i<argc; ++i){
+		if(argv[i][0] == '-'){
+			if(i + 1 >= argc)
+				usage();
+			const char* value(argv[++i]);
+			if(!strcmp(argv[i - 1], "-seconds"))
+				options.seconds = float(atof(value));
+			else if(!strcmp(argv[i - 1], "-frametime"))
+				options.frameTime = float(atof(value));
+			else if(!strcmp(argv[i - 1], "-simrate"))
+				options.simRate = atoi(value);
+			else if(!strcmp(argv[i - 1], "-threads"))
+				options.threads = atoi(value);
+			else if(!strcmp(argv[i - 1], "-seed"))
+				options.seed = (unsigned int)strtoul(value, NULL, 10);
+			else if(!strcmp(argv[i - 1], "-maxparticles"))
+				options.maxParticles = atoi(value);
+			else if(!strcmp(argv[i - 1], "-simd"))
+				options.simd = atoi(value);
+			else if(!strcmp(argv[i - 1], "-record"))
+				options.record = value;
+			else if(!strcmp(argv[i - 1], "-replay"))
+				options.replay = value;
+			else
+				usage();
+		}
+		else{
+			unsigned int j;
+			for(j=0; j<NUMSCENARIOS; ++j){
+				if(!strcmp(argv[i], scenarios[j].name)){
+					torun.push_back(&scenarios[j]);
+					break;
+				}
+			}
+			if(j == NUMSCENARIOS)
+				usage();
+		}
+	}
+	if(torun.empty() && !options.replay){
+		for(unsigned int j=0; j<NUMSCENARIOS; ++j)
+			torun.push_back(&scenarios[j]);
+	}
+	if(options.frameTime <= 0.0f || options.seconds < 0.0f || !options.seed || options.simRate < 0)
+		usage();
+	// a log holds one show
+	if(options.record && (options.replay || torun.size() != 1))
+		usage();
+	if(options.replay && !torun.empty())
+		usage();
+
+	// chooseKinematics() is called again by initSim(); this is just for the name
+	chooseKinematics(options.simd);
+	printf("{\n");
+	printf("  \"seconds\": %g,\n", options.seconds);
+	printf("  \"frameTime\": %g,\n", options.frameTime);
+	printf("  \"simRate\": %d,\n", options.simRate);
+	printf("  \"threads\": %d,\n", options.threads);
+	printf("  \"seed\": %u,\n", options.seed);
+	printf("  \"maxParticles\": %d,\n", options.maxParticles);
+	printf("  \"kinematics\": \"%s\",\n", kinematicsName());
+	printf("  \"scenarios\": [\n");
+	if(options.replay)
+		runScenario(NULL, options, true);
+	for(unsigned int i=0; i<torun.size(); ++i)
+		runScenario(torun[i], options, i + 1 == torun.size());
+	printf("  ]\n");
+	printf("}\n");
+
+	return 0;
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <stddef.h>
+#include <string.h>
+#include "billboard.h"
+#include "glshader.h"
+#include "Skyrocket.h"
+
+
+// Attribute locations in billboardProgram
+#define ATTRIB_CORNER 0
+#define ATTRIB_CENTER 1
+#define ATTRIB_COLOR 2
+#define ATTRIB_SPRITE 3
+
+// Every sprite is a tile in one texture.  Flares get the top row of 128x128
+// tiles and smoke the row of 64x64 tiles below it.
+#define ATLASWIDTH 512
+#define ATLASHEIGHT 256
+static const int spriteTiles[NUMSPRITES][3] = {  // x, y, largest size
+	{0, 0, 128}, {128, 0, 128}, {256, 0, 128}, {384, 0, 128},
+	{0, 128, 64}, {64, 128, 64}, {128, 128, 64}, {192, 128, 64}, {256, 128, 64}};
+
+
+// A square from -0.5 to 0.5 in the billboard's right and up directions,
+// just like the flare and smoke display lists
+static const char* billboardVertexShader =
+	"#version 120\n"
+	"attribute vec2 corner;\n"
+	"attribute vec4 center;  // position, size\n"
+	"attribute vec4 color;\n"
+	"attribute float sprite;\n"
+	"uniform vec3 right;\n"
+	"uniform vec3 up;\n"
+	"uniform vec4 spriteRects[9];\n"
+	"void main(){\n"
+	"	vec3 pos = center.xyz + (right * corner.x + up * corner.y) * center.w;\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 1.0);\n"
+	"	gl_FrontColor = color;\n"
+	"	vec4 rect = spriteRects[int(sprite + 0.5)];\n"
+	"	gl_TexCoord[0] = vec4(mix(rect.xy, rect.zw, corner + 0.5), 0.0, 1.0);\n"
+	"}\n";
+static const char* billboardFragmentShader =
+	"#version 120\n"
+	"uniform sampler2D sprites;\n"
+	"void main(){\n"
+	"	gl_FragColor = gl_Color * texture2D(sprites, gl_TexCoord[0].st);\n"
+	"}\n";
+
+static GLuint atlasTexture = 0;
+// Texture coordinates of each sprite's corners in the atlas:  left, bottom,
+// right, top.  They stop half a texel inside the tile so that filtering never
+// reaches into the neighboring sprite.
+static float spriteRects[NUMSPRITES][4];
+static GLuint billboardProgram = 0;  // 0 if billboards use plain vertex arrays
+static GLuint cornerBuffer = 0;
+static GLuint instanceBuffer = 0;
+static GLint rightLocation, upLocation;
+// for plain vertex arrays:  4 corners of position, texture coordinate, and color per billboard
+static std::vector<float> quadVertices;
+
+
+
+void setSprite(unsigned int sprite, int size, unsigned int format, const unsigned char* texels){
+	if(sprite >= NUMSPRITES || size > spriteTiles[sprite][2])
+		return;
+	if(!atlasTexture){
+		glGenTextures(1, &atlasTexture);
+		glBindTexture(GL_TEXTURE_2D, atlasTexture);
+		// no mipmaps, since they would blend neighboring sprites together
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLASWIDTH, ATLASHEIGHT, 0, GL_RGBA,
+			GL_UNSIGNED_BYTE, NULL);
+	}
+	const int x(spriteTiles[sprite][0]), y(spriteTiles[sprite][1]);
+	glBindTexture(GL_TEXTURE_2D, atlasTexture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, size, size, format, GL_UNSIGNED_BYTE, texels);
+	spriteRects[sprite][0] = (float(x) + 0.5f) / float(ATLASWIDTH);
+	spriteRects[sprite][1] = (float(y) + 0.5f) / float(ATLASHEIGHT);
+	spriteRects[sprite][2] = (float(x + size) - 0.5f) / float(ATLASWIDTH);
+	spriteRects[sprite][3] = (float(y + size) - 0.5f) / float(ATLASHEIGHT);
+}
+
+
+int initBillboards(){
+	const char* extensions((const char*)glGetString(GL_EXTENSIONS));
+	if(!extensions || !strstr(extensions, "GL_ARB_instanced_arrays")
+		|| !strstr(extensions, "GL_ARB_draw_instanced"))
+		return 0;
+
+	const shaderAttrib attribs[4] = {{ATTRIB_CORNER, "corner"}, {ATTRIB_CENTER, "center"},
+		{ATTRIB_COLOR, "color"}, {ATTRIB_SPRITE, "sprite"}};
+	billboardProgram = linkShaderProgram(billboardVertexShader, billboardFragmentShader, attribs, 4);
+	if(!billboardProgram)
+		return 0;
+
+	glUseProgram(billboardProgram);
+	glUniform1i(glGetUniformLocation(billboardProgram, "sprites"), 0);
+	glUniform4fv(glGetUniformLocation(billboardProgram, "spriteRects"), NUMSPRITES, &spriteRects[0][0]);
+	rightLocation = glGetUniformLocation(billboardProgram, "right");
+	upLocation = glGetUniformLocation(billboardProgram, "up");
+	glUseProgram(0);
+
+	// same corners, in the same order, as the display lists' triangle strip
+	static const float corners[8] = {-0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+	glGenBuffers(1, &cornerBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, cornerBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+	glGenBuffers(1, &instanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return 1;
+}
+
+
+static void drawInstanced(const std::vector<billboard> &list, unsigned int &stateChanges,
+	SkyrocketSaverSettings *inSettings){
+	const float* bm(inSettings->billboardMat);
+	glUseProgram(billboardProgram);
+	++stateChanges;
+	glUniform3f(rightLocation, bm[0], bm[1], bm[2]);
+	glUniform3f(upLocation, bm[4], bm[5], bm[6]);
+
+	glBindBuffer(GL_ARRAY_BUFFER, cornerBuffer);
+	glEnableVertexAttribArray(ATTRIB_CORNER);
+	glVertexAttribPointer(ATTRIB_CORNER, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+	// a new buffer every time, so the driver doesn't wait on the last frame's
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, list.size() * sizeof(billboard), &list[0], GL_STREAM_DRAW);
+	glEnableVertexAttribArray(ATTRIB_CENTER);
+	glVertexAttribPointer(ATTRIB_CENTER, 4, GL_FLOAT, GL_FALSE, sizeof(billboard), (void*)offsetof(billboard, xyz));
+	glVertexAttribDivisorARB(ATTRIB_CENTER, 1);
+	glEnableVertexAttribArray(ATTRIB_COLOR);
+	glVertexAttribPointer(ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(billboard), (void*)offsetof(billboard, rgba));
+	glVertexAttribDivisorARB(ATTRIB_COLOR, 1);
+	glEnableVertexAttribArray(ATTRIB_SPRITE);
+	glVertexAttribPointer(ATTRIB_SPRITE, 1, GL_FLOAT, GL_FALSE, sizeof(billboard), (void*)offsetof(billboard, sprite));
+	glVertexAttribDivisorARB(ATTRIB_SPRITE, 1);
+
+	glDrawArraysInstancedARB(GL_TRIANGLE_STRIP, 0, 4, GLsizei(list.size()));
+
+	glVertexAttribDivisorARB(ATTRIB_CENTER, 0);
+	glVertexAttribDivisorARB(ATTRIB_COLOR, 0);
+	glVertexAttribDivisorARB(ATTRIB_SPRITE, 0);
+	glDisableVertexAttribArray(ATTRIB_CORNER);
+	glDisableVertexAttribArray(ATTRIB_CENTER);
+	glDisableVertexAttribArray(ATTRIB_COLOR);
+	glDisableVertexAttribArray(ATTRIB_SPRITE);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glUseProgram(0);
+	++stateChanges;
+}
+
+
+// Every billboard goes into quadVertices
+static void buildQuads(const std::vector<billboard> &list, SkyrocketSaverSettings *inSettings){
+	const float* bm(inSettings->billboardMat);
+	// corners of a quad in counterclockwise order
+	static const float corners[4][2] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}};
+	// which of a sprite's texture coordinates each corner gets
+	static const int cornerUV[4][2] = {{0, 1}, {2, 1}, {2, 3}, {0, 3}};
+	const unsigned int count(list.size());
+	quadVertices.resize(count * 4 * 9);
+	float* v(&quadVertices[0]);
+	for(unsigned int n=0; n<count; ++n){
+		const billboard& b(list[n]);
+		const float* rect(spriteRects[unsigned(b.sprite)]);
+		for(int c=0; c<4; ++c){
+			const float cx(corners[c][0] * b.size), cy(corners[c][1] * b.size);
+			v[0] = b.xyz[0] + bm[0] * cx + bm[4] * cy;
+			v[1] = b.xyz[1] + bm[1] * cx + bm[5] * cy;
+			v[2] = b.xyz[2] + bm[2] * cx + bm[6] * cy;
+			v[3] = rect[cornerUV[c][0]];
+			v[4] = rect[cornerUV[c][1]];
+			v[5] = b.rgba[0];
+			v[6] = b.rgba[1];
+			v[7] = b.rgba[2];
+			v[8] = b.rgba[3];
+			v += 9;
+		}
+	}
+}
+
+
+static void drawArrays(const std::vector<billboard> &list, SkyrocketSaverSettings *inSettings){
+	buildQuads(list, inSettings);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 9 * sizeof(float), &quadVertices[0]);
+	glTexCoordPointer(2, GL_FLOAT, 9 * sizeof(float), &quadVertices[3]);
+	glColorPointer(4, GL_FLOAT, 9 * sizeof(float), &quadVertices[5]);
+	glDrawArrays(GL_QUADS, 0, GLsizei(list.size() * 4));
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+}
+
+
+void drawBillboards(const std::vector<billboard> &list, int withArrays, unsigned int &stateChanges,
+	SkyrocketSaverSettings *inSettings){
+	if(list.empty())
+		return;
+	if(billboardProgram && !withArrays)
+		drawInstanced(list, stateChanges, inSettings);
+	else
+		drawArrays(list, inSettings);
+}
+
+
+void drawScreenSprites(const std::vector<screenSprite> &list){
+	if(list.empty())
+		return;
+	// corners of a quad in counterclockwise order
+	static const float corners[4][2] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}};
+	static const int cornerUV[4][2] = {{0, 1}, {2, 1}, {2, 3}, {0, 3}};
+	const unsigned int count(list.size());
+	quadVertices.resize(count * 4 * 9);
+	float* v(&quadVertices[0]);
+	for(unsigned int n=0; n<count; ++n){
+		const screenSprite& s(list[n]);
+		const float* rect(spriteRects[s.sprite]);
+		for(int c=0; c<4; ++c){
+			v[0] = s.xy[0] + s.right[0] * corners[c][0] + s.up[0] * corners[c][1];
+			v[1] = s.xy[1] + s.right[1] * corners[c][0] + s.up[1] * corners[c][1];
+			v[2] = 0.0f;
+			v[3] = rect[cornerUV[c][0]];
+			v[4] = rect[cornerUV[c][1]];
+			v[5] = s.rgba[0];
+			v[6] = s.rgba[1];
+			v[7] = s.rgba[2];
+			v[8] = s.rgba[3];
+			v += 9;
+		}
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 9 * sizeof(float), &quadVertices[0]);
+	glTexCoordPointer(2, GL_FLOAT, 9 * sizeof(float), &quadVertices[3]);
+	glColorPointer(4, GL_FLOAT, 9 * sizeof(float), &quadVertices[5]);
+	glDrawArrays(GL_QUADS, 0, GLsizei(count * 4));
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+}
+
+
+void drawSprite(unsigned int sprite){
+	if(sprite >= NUMSPRITES)
+		return;
+	const float* rect(spriteRects[sprite]);
+	glBindTexture(GL_TEXTURE_2D, atlasTexture);
+	glBegin(GL_TRIANGLE_STRIP);
+		glTexCoord2f(rect[0], rect[1]);
+		glVertex3f(-0.5f, -0.5f, 0.0f);
+		glTexCoord2f(rect[2], rect[1]);
+		glVertex3f(0.5f, -0.5f, 0.0f);
+		glTexCoord2f(rect[0], rect[3]);
+		glVertex3f(-0.5f, 0.5f, 0.0f);
+		glTexCoord2f(rect[2], rect[3]);
+		glVertex3f(0.5f, 0.5f, 0.0f);
+	glEnd();
+}
+
+
+unsigned int spriteAtlas(){
+	return atlasTexture;
+}
+
+
+void cleanupBillboards(){
+	if(billboardProgram)
+		glDeleteProgram(billboardProgram);
+	if(cornerBuffer)
+		glDeleteBuffers(1, &cornerBuffer);
+	if(instanceBuffer)
+		glDeleteBuffers(1, &instanceBuffer);
+	if(atlasTexture)
+		glDeleteTextures(1, &atlasTexture);
+	billboardProgram = 0;
+	cornerBuffer = instanceBuffer = 0;
+	atlasTexture = 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef BILLBOARD_H
+#define BILLBOARD_H
+
+
+
+#include <vector>
+
+struct SkyrocketSaverSettings;
+
+
+// Sprites a billboard can use
+#define SPRITE_FLARE 0  // flares 0 - 3 (initFlares())
+#define SPRITE_SMOKE 4  // smoke 4 - 8 (initSmoke())
+#define NUMSPRITES 9
+
+
+// One textured square facing the camera, like a particle's display list
+// drawn with billboardMat
+struct billboard{
+	float xyz[3];
+	float size;
+	float rgba[4];
+	float sprite;  // SPRITE_ value
+};
+
+
+// One square sprite drawn flat on the screen, like a flare display list drawn
+// after glTranslatef(), glRotatef(), and glScalef().  right and up are the
+// square's edges, so they carry its size and rotation.
+struct screenSprite{
+	float xy[2];
+	float right[2];
+	float up[2];
+	float rgba[4];
+	unsigned int sprite;  // SPRITE_ value
+};
+
+
+// Draws lots of billboards with a handful of OpenGL calls.  All the sprites
+// share one texture atlas, so a whole list is drawn with one texture binding
+// and one draw call.  With shaders and instanced arrays, every billboard
+// becomes one instance of a square that the vertex shader turns to face the
+// camera and maps onto its sprite's part of the atlas.  Otherwise the squares
+// are built on the CPU into a vertex array.
+
+// Copy a sprite's texels into the atlas.  format is GL_RGBA or
+// GL_LUMINANCE_ALPHA, and the sprite is size texels square.  initFlares() and
+// initSmoke() call this for their textures.
+void setSprite(unsigned int sprite, int size, unsigned int format, const unsigned char* texels);
+// Call after initFlares() and initSmoke().  Returns 1 if billboards will be
+// instanced, 0 if they'll use plain vertex arrays.
+int initBillboards();
+// The texture holding every sprite.  Bind it before drawing billboards or
+// screen sprites.
+unsigned int spriteAtlas();
+// Draw a list of billboards in order with the current blend function.
+// withArrays forces plain vertex arrays, for a caller's own shader program.
+// Adds the shader programs it sets to stateChanges.
+void drawBillboards(const std::vector<billboard> &list, int withArrays, unsigned int &stateChanges,
+	SkyrocketSaverSettings *inSettings);
+// Draw screen sprites in order, as one vertex array, with the current
+// projection and blend function
+void drawScreenSprites(const std::vector<screenSprite> &list);
+// Draw one sprite as a square from -0.5 to 0.5 in x and y, with the current
+// matrices, color, and blend function.  Binds the atlas.
+void drawSprite(unsigned int sprite);
+void cleanupBillboards();
+
+
+
+#endif  // BILLBOARD_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "depthsort.h"
+#include "particle.h"
+
+
+// Above this much smoke, depths are sorted into fewer layers so that one
+// counting pass does instead of two.  At 60 frames per second either way
+// stays well under a millisecond.
+#define SORTBUDGET 65536
+// Depth layers for each size of show
+#define SORTFINEBITS 16
+#define SORTCOARSEBITS 11
+
+
+
+// One stable counting sort pass on bits shift to shift+bits-1 of the keys
+static void countingPass(const unsigned short* keys, const unsigned int* items, unsigned int count,
+	unsigned int shift, unsigned int bits, unsigned short* outKeys, unsigned int* outItems){
+	unsigned int starts[1 << SORTCOARSEBITS];
+	const unsigned int buckets(1 << bits);
+	const unsigned int mask(buckets - 1);
+	for(unsigned int b=0; b<buckets; ++b)
+		starts[b] = 0;
+	for(unsigned int n=0; n<count; ++n)
+		++starts[(keys[n] >> shift) & mask];
+	unsigned int total(0);
+	for(unsigned int b=0; b<buckets; ++b){
+		const unsigned int size(starts[b]);
+		starts[b] = total;
+		total += size;
+	}
+	for(unsigned int n=0; n<count; ++n){
+		const unsigned int to(starts[(keys[n] >> shift) & mask]++);
+		outKeys[to] = keys[n];
+		outItems[to] = items[n];
+	}
+}
+
+
+void depthSort::sort(const particleStore &store, const std::vector<unsigned int> &visible,
+	const double* modelMat, float t){
+	const unsigned int* type(store.type);
+	const unsigned int stride(store.capacity);
+	const float* x(store.xyz);
+	const float* lx(store.lastxyz);
+	// depth is minus the eye space z
+	const float mx(-float(modelMat[2])), my(-float(modelMat[6])), mz(-float(modelMat[10])), mw(-float(modelMat[14]));
+
+	// gather visible smoke and its depth range
+	order.clear();
+	depths.clear();
+	float nearest(0.0f), farthest(0.0f);
+	for(unsigned int n=0; n<visible.size(); ++n){
+		const unsigned int i(visible[n]);
+		if(type[i] != SMOKE)
+			continue;
+		float p[3];
+		for(unsigned int j=0; j<3; ++j){
+			const float last(lx[i + stride * j]), now(x[i + stride * j]);
+			p[j] = t < 1.0f ? last + (now - last) * t : now;
+		}
+		const float depth(mx * p[0] + my * p[1] + mz * p[2] + mw);
+		if(depth < 0.0f)
+			continue;
+		if(order.empty())
+			nearest = farthest = depth;
+		else if(depth < nearest)
+			nearest = depth;
+		else if(depth > farthest)
+			farthest = depth;
+		order.push_back(i);
+		depths.push_back(depth);
+	}
+	const unsigned int smoke(order.size());
+	if(smoke < 2 || farthest == nearest)
+		return;
+
+	// Keys grow toward the camera, so sorting them up puts the farthest smoke
+	// first.  Smoke at the same depth stays in particle order.
+	const unsigned int bits(smoke > SORTBUDGET ? SORTCOARSEBITS : SORTFINEBITS);
+	const unsigned int top((1 << bits) - 1);
+	const float scale(float(top) / (farthest - nearest));
+	keys.resize(smoke);
+	scratchKeys.resize(smoke);
+	scratch.resize(smoke);
+	for(unsigned int n=0; n<smoke; ++n){
+		const unsigned int key((farthest - depths[n]) * scale);
+		keys[n] = (unsigned short)(key > top ? top : key);
+	}
+
+	if(bits == SORTCOARSEBITS){
+		countingPass(&keys[0], &order[0], smoke, 0, SORTCOARSEBITS, &scratchKeys[0], &scratch[0]);
+		order.swap(scratch);
+	}
+	else{
+		countingPass(&keys[0], &order[0], smoke, 0, 8, &scratchKeys[0], &scratch[0]);
+		countingPass(&scratchKeys[0], &scratch[0], smoke, 8, 8, &keys[0], &order[0]);
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef DEPTHSORT_H
+#define DEPTHSORT_H
+
+
+
+#include <vector>
+
+class particleStore;
+
+
+// Back to front drawing order for SMOKE, the only particles drawn with
+// GL_ONE_MINUS_SRC_ALPHA.  Everything else is additive and looks the same
+// in any order, so it isn't sorted.  Smoke depths are quantized and radix
+// sorted, which costs the same few passes over the smoke however it moved.
+// Drawing sorts once per drawn frame, after frustumCull, so only smoke that
+// will be drawn is sorted, by where it is drawn.
+class depthSort{
+public:
+	std::vector<unsigned int> order;  // visible smoke, farthest first
+
+	// Sort the SMOKE among visible (frustumCull::visible) by its distance in
+	// front of the camera of modelMat (OpenGL's column-major order).  Particles
+	// are drawn t of the way from lastxyz to xyz (see stepSim()); pass 1 to
+	// use xyz.  Smoke behind the camera is left out.
+	void sort(const particleStore &store, const std::vector<unsigned int> &visible,
+		const double* modelMat, float t);
+
+private:
+	std::vector<float> depths;  // of the smoke in order, before sorting
+	std::vector<unsigned int> scratch;
+	std::vector<unsigned short> keys;
+	std::vector<unsigned short> scratchKeys;
+};
+
+
+
+#endif
@@ -20,7 +20,10 @@
 
 
 //#include <Skyrocket/flare.h>
+#include <OpenGL/gl.h>
+#include <math.h>
 #include "flare.h"
+#include "billboard.h"
 #include "Skyrocket.h"
 
 using std::max;
@@ -29,18 +32,15 @@ unsigned char flare1[FLARESIZE][FLARESIZE][4];
 unsigned char flare2[FLARESIZE][FLARESIZE][4];
 unsigned char flare3[FLARESIZE][FLARESIZE][4];
 unsigned char flare4[FLARESIZE][FLARESIZE][4];
-unsigned int flaretex[4];
 
 
 // Generate textures for lens flares
-// then applies textures to geometry in display lists
+// and copy them into the sprite atlas
 void initFlares(SkyrocketSaverSettings *inSettings){
 	int i, j;
 	float x, y;
 	float temp;
 
-	glGenTextures(4, flaretex);
-
 	// First flare:  basic sphere
 	for(i=0; i<FLARESIZE; i++){
 		for(j=0; j<FLARESIZE; j++){
@@ -57,11 +57,7 @@ void initFlares(SkyrocketSaverSettings *inSettings){
 			flare1[i][j][3] = (unsigned char)(255.0f * temp * temp * temp * temp);
 		}
 	}
-	glBindTexture(GL_TEXTURE_2D, flaretex[0]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, 4, FLARESIZE, FLARESIZE, 0, GL_RGBA,
-		GL_UNSIGNED_BYTE, flare1);
+	setSprite(SPRITE_FLARE + 0, FLARESIZE, GL_RGBA, &flare1[0][0][0]);
 
 	// Second flare:  flattened sphere
 	for(i=0; i<FLARESIZE; i++){
@@ -80,11 +76,7 @@ void initFlares(SkyrocketSaverSettings *inSettings){
 			flare2[i][j][3] = (unsigned char)(255.0f * temp);
 		}
 	}
-	glBindTexture(GL_TEXTURE_2D, flaretex[1]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, 4, FLARESIZE, FLARESIZE, 0, GL_RGBA,
-		GL_UNSIGNED_BYTE, flare2);
+	setSprite(SPRITE_FLARE + 1, FLARESIZE, GL_RGBA, &flare2[0][0][0]);
 
 	// Third flare:  torus
 	for(i=0; i<FLARESIZE; i++){
@@ -102,11 +94,7 @@ void initFlares(SkyrocketSaverSettings *inSettings){
 			flare3[i][j][3] = (unsigned char)(255.0f * temp * temp * temp * temp);
 		}
 	}
-	glBindTexture(GL_TEXTURE_2D, flaretex[2]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, 4, FLARESIZE, FLARESIZE, 0, GL_RGBA,
-		GL_UNSIGNED_BYTE, flare3);
+	setSprite(SPRITE_FLARE + 2, FLARESIZE, GL_RGBA, &flare3[0][0][0]);
 
 	// Fourth flare:  weird flare
 	for(i=0; i<FLARESIZE; i++){
@@ -133,45 +121,39 @@ void initFlares(SkyrocketSaverSettings *inSettings){
 			flare4[i][j][3] = (unsigned char)(255.0f * temp);
 		}
 	}
-	glBindTexture(GL_TEXTURE_2D, flaretex[3]);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, 4, FLARESIZE, FLARESIZE, 0, GL_RGBA,
-		GL_UNSIGNED_BYTE, flare4);
+	setSprite(SPRITE_FLARE + 3, FLARESIZE, GL_RGBA, &flare4[0][0][0]);
+}
 
-	// Build display lists
-	inSettings->flarelist[0] = glGenLists(4);
-	inSettings->flarelist[1] = inSettings->flarelist[0] + 1;
-	inSettings->flarelist[2] = inSettings->flarelist[0] + 2;
-	inSettings->flarelist[3] = inSettings->flarelist[0] + 3;
-	for(i=0; i<4; i++){
-		glNewList(inSettings->flarelist[i], GL_COMPILE);
-			glBindTexture(GL_TEXTURE_2D, flaretex[i]);
-			glBegin(GL_TRIANGLE_STRIP);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(-0.5f, -0.5f, 0.0f);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex3f(0.5f, -0.5f, 0.0f);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(-0.5f, 0.5f, 0.0f);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(0.5f, 0.5f, 0.0f);
-			glEnd();
-		glEndList();
-	}
+
+// Add one piece of a lens flare:  a flare sprite centered on (x,y), scaled by
+// (sx,sy), and turned by angle degrees
+static void addFlareSprite(std::vector<screenSprite> &sprites, float x, float y, float sx, float sy, float angle,
+	float red, float green, float blue, float alpha, unsigned int sprite){
+	const float c(cosf(angle * RS_DEG2RAD)), s(sinf(angle * RS_DEG2RAD));
+	screenSprite f;
+	f.xy[0] = x;
+	f.xy[1] = y;
+	f.right[0] = c * sx;
+	f.right[1] = s * sx;
+	f.up[0] = -s * sy;
+	f.up[1] = c * sy;
+	f.rgba[0] = red;
+	f.rgba[1] = green;
+	f.rgba[2] = blue;
+	f.rgba[3] = alpha;
+	f.sprite = SPRITE_FLARE + sprite;
+	sprites.push_back(f);
 }
 
 
-// Draw a flare at a specified (x,y) location on the screen
+// Add a flare at a specified (x,y) location on the screen
 // Screen corners are at (0,0) and (1,1)
 // alpha = 0.0 for lowest intensity; alpha = 1.0 for highest intensity
-void flare(float x, float y, float red, float green, float blue, float alpha, SkyrocketSaverSettings *inSettings){
+void flare(float x, float y, float red, float green, float blue, float alpha,
+	std::vector<screenSprite> &sprites, SkyrocketSaverSettings *inSettings){
 	float dx, dy;
 	float fadewidth, temp;
 
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-	glEnable(GL_BLEND);
-
 	// Fade alpha if source is off edge of screen
 	fadewidth = float(inSettings->xsize) / 10.0f;
 	if(y < 0){
@@ -203,83 +185,17 @@ void flare(float x, float y, float red, float green, float blue, float alpha, Sk
 	// This vector runs from the light source through the screen's center
 	dx = 0.5f * inSettings->aspectRatio - x;
 	dy = 0.5f - y;
-	
-	// Setup projection matrix
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	glLoadIdentity();
-	gluOrtho2D(0, inSettings->aspectRatio, 0, 1.0f);
-
-	// Draw stuff
-	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
 
 	// wide flare
-	glLoadIdentity();
-	glTranslatef(x, y, 0.0f);
-	glScalef(5.0f * alpha, 0.05f * alpha, 1.0f);
-	glColor4f(red * 0.25f, green * 0.25f, blue, alpha);
-	glCallList(inSettings->flarelist[0]);
-
-	glLoadIdentity();
-	glTranslatef(x, y, 0.0f);
-	glScalef(0.5f, 0.2f, 1.0f);
-	glColor4f(red, green * 0.4f, blue * 0.4f, alpha * 0.4f);
-	glCallList(inSettings->flarelist[2]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 0.15f, y + dy * 0.15f, 0.0f);
-	glScalef(0.04f, 0.04f, 1.0f);
-	glColor4f(red * 0.9f, green * 0.9f, blue, alpha * 0.9f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 0.25f, y + dy * 0.25f, 0.0f);
-	glScalef(0.06f, 0.06f, 1.0f);
-	glColor4f(red * 0.8f, green * 0.8f, blue, alpha * 0.9f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 0.35f, y + dy * 0.35f, 0.0f);
-	glScalef(0.08f, 0.08f, 1.0f);
-	glColor4f(red * 0.7f, green * 0.7f, blue, alpha * 0.9f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 1.25f, y + dy * 1.25f, 0.0f);
-	glScalef(0.05f, 0.05f, 1.0f);
-	glColor4f(red, green * 0.6f, blue * 0.6f, alpha * 0.9f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 1.65f, y + dy * 1.65f, 0.0f);
-	glRotatef(x, 0, 0, 1);
-	glScalef(0.3f, 0.3f, 1.0f);
-	glColor4f(red, green, blue, alpha);
-	glCallList(inSettings->flarelist[3]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 1.85f, y + dy * 1.85f, 0.0f);
-	glScalef(0.04f, 0.04f, 1.0f);
-	glColor4f(red, green * 0.6f, blue * 0.6f, alpha * 0.9f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 2.2f, y + dy * 2.2f, 0.0f);
-	glScalef(0.3f, 0.3f, 1.0f);
-	glColor4f(red, green, blue, alpha * 0.7f);
-	glCallList(inSettings->flarelist[1]);
-
-	glLoadIdentity();
-	glTranslatef(x + dx * 2.5f, y + dy * 2.5f, 0.0f);
-	glScalef(0.6f, 0.6f, 1.0f);
-	glColor4f(red, green, blue, alpha * 0.8f);
-	glCallList(inSettings->flarelist[3]);
-
-	glPopMatrix();
-
-	// Unsetup projection matrix
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-	glMatrixMode(GL_MODELVIEW);
+	addFlareSprite(sprites, x, y, 5.0f * alpha, 0.05f * alpha, 0.0f, red * 0.25f, green * 0.25f, blue, alpha, 0);
+
+	addFlareSprite(sprites, x, y, 0.5f, 0.2f, 0.0f, red, green * 0.4f, blue * 0.4f, alpha * 0.4f, 2);
+	addFlareSprite(sprites, x + dx * 0.15f, y + dy * 0.15f, 0.04f, 0.04f, 0.0f, red * 0.9f, green * 0.9f, blue, alpha * 0.9f, 1);
+	addFlareSprite(sprites, x + dx * 0.25f, y + dy * 0.25f, 0.06f, 0.06f, 0.0f, red * 0.8f, green * 0.8f, blue, alpha * 0.9f, 1);
+	addFlareSprite(sprites, x + dx * 0.35f, y + dy * 0.35f, 0.08f, 0.08f, 0.0f, red * 0.7f, green * 0.7f, blue, alpha * 0.9f, 1);
+	addFlareSprite(sprites, x + dx * 1.25f, y + dy * 1.25f, 0.05f, 0.05f, 0.0f, red, green * 0.6f, blue * 0.6f, alpha * 0.9f, 1);
+	addFlareSprite(sprites, x + dx * 1.65f, y + dy * 1.65f, 0.3f, 0.3f, x, red, green, blue, alpha, 3);
+	addFlareSprite(sprites, x + dx * 1.85f, y + dy * 1.85f, 0.04f, 0.04f, 0.0f, red, green * 0.6f, blue * 0.6f, alpha * 0.9f, 1);
+	addFlareSprite(sprites, x + dx * 2.2f, y + dy * 2.2f, 0.3f, 0.3f, 0.0f, red, green, blue, alpha * 0.7f, 1);
+	addFlareSprite(sprites, x + dx * 2.5f, y + dy * 2.5f, 0.6f, 0.6f, 0.0f, red, green, blue, alpha * 0.8f, 3);
 }
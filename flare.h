@@ -27,8 +27,9 @@
 /*#include <windows.h>
 #include <gl/gl.h>
 #include <gl/glu.h>*/
-#include <OpenGL/gl.h>
-#include <OpenGL/glu.h>
+
+
+#include <vector>
 
 
 #define FLARESIZE 128
@@ -41,9 +42,10 @@ extern double modelMat[16], projMat[16];
 //extern int viewport[4];
 extern GLint viewport[4];*/
 typedef struct SkyrocketSaverSettings;
+struct screenSprite;
 
 // Generate textures for lens flares
-// then applies textures to geometry in display lists
+// and copy them into the sprite atlas
 void initFlares(SkyrocketSaverSettings *inSettings);
 
 
@@ -52,10 +54,12 @@ struct flareData{
 };
 
 
-// Draw a flare at a specified (x,y) location on the screen
+// Add a flare at a specified (x,y) location on the screen to a list of
+// sprites for drawScreenSprites()
 // Screen corners are at (0,0) and (1,1)
 // alpha = 0.0 for lowest intensity; alpha = 1.0 for highest intensity
-void flare(float x, float y, float red, float green, float blue, float alpha, SkyrocketSaverSettings *inSettings);
+void flare(float x, float y, float red, float green, float blue, float alpha,
+	std::vector<screenSprite> &sprites, SkyrocketSaverSettings *inSettings);
 
 
 
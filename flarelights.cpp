@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "flarelights.h"
+#include "Skyrocket.h"
+#include "particle.h"
+#include <math.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#define FLARELIGHTS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define FLARELIGHTS_NEON
+#include <arm_neon.h>
+#endif
+
+
+// Lights closer together than this on the screen (in screen heights) share a flare
+#define FLARECLUSTER 0.02f
+
+
+// Everything the projection kernel needs
+struct flareProjection{
+	float m[16];  // projMat * modelMat
+	float xScale, xOffset;  // screen x = xOffset + xScale * normalized device x
+	float yScale, yOffset;
+	float eye[3];
+	float dir[3];  // where the camera looks
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* gain;
+	const float* reach;
+};
+
+
+// Reference version.  The SIMD kernels do the same operations in the same
+// order.  Lights that aren't in front of the camera get an alpha of 0.
+static void projectScalar(const flareProjection &p, unsigned int first, unsigned int last,
+	float* sx, float* sy, float* alpha){
+	for(unsigned int i=first; i<last; ++i){
+		const float px(p.x[i]), py(p.y[i]), pz(p.z[i]);
+		const float cx(p.m[0] * px + p.m[4] * py + p.m[8] * pz + p.m[12]);
+		const float cy(p.m[1] * px + p.m[5] * py + p.m[9] * pz + p.m[13]);
+		const float cw(p.m[3] * px + p.m[7] * py + p.m[11] * pz + p.m[15]);
+		sx[i] = p.xOffset + p.xScale * (cx / cw);
+		sy[i] = p.yOffset + p.yScale * (cy / cw);
+		const float dx(px - p.eye[0]), dy(py - p.eye[1]), dz(pz - p.eye[2]);
+		const float ahead(dx * p.dir[0] + dy * p.dir[1] + dz * p.dir[2]);
+		const float dist(sqrtf(dx * dx + dy * dy + dz * dz));
+		float a(p.gain[i] * std::max(0.0f, (p.reach[i] - dist) / p.reach[i]));
+		alpha[i] = ahead > 1.0f ? a : 0.0f;
+	}
+}
+
+
+#ifdef FLARELIGHTS_SSE2
+static void projectSSE2(const flareProjection &p, unsigned int last, float* sx, float* sy, float* alpha){
+	unsigned int i(0);
+	for(; i+4<=last; i+=4){
+		const __m128 px(_mm_loadu_ps(p.x + i));
+		const __m128 py(_mm_loadu_ps(p.y + i));
+		const __m128 pz(_mm_loadu_ps(p.z + i));
+		__m128 cx(_mm_mul_ps(_mm_set1_ps(p.m[0]), px));
+		cx = _mm_add_ps(cx, _mm_mul_ps(_mm_set1_ps(p.m[4]), py));
+		cx = _mm_add_ps(cx, _mm_mul_ps(_mm_set1_ps(p.m[8]), pz));
+		cx = _mm_add_ps(cx, _mm_set1_ps(p.m[12]));
+		__m128 cy(_mm_mul_ps(_mm_set1_ps(p.m[1]), px));
+		cy = _mm_add_ps(cy, _mm_mul_ps(_mm_set1_ps(p.m[5]), py));
+		cy = _mm_add_ps(cy, _mm_mul_ps(_mm_set1_ps(p.m[9]), pz));
+		cy = _mm_add_ps(cy, _mm_set1_ps(p.m[13]));
+		__m128 cw(_mm_mul_ps(_mm_set1_ps(p.m[3]), px));
+		cw = _mm_add_ps(cw, _mm_mul_ps(_mm_set1_ps(p.m[7]), py));
+		cw = _mm_add_ps(cw, _mm_mul_ps(_mm_set1_ps(p.m[11]), pz));
+		cw = _mm_add_ps(cw, _mm_set1_ps(p.m[15]));
+		_mm_storeu_ps(sx + i, _mm_add_ps(_mm_set1_ps(p.xOffset), _mm_mul_ps(_mm_set1_ps(p.xScale), _mm_div_ps(cx, cw))));
+		_mm_storeu_ps(sy + i, _mm_add_ps(_mm_set1_ps(p.yOffset), _mm_mul_ps(_mm_set1_ps(p.yScale), _mm_div_ps(cy, cw))));
+		const __m128 dx(_mm_sub_ps(px, _mm_set1_ps(p.eye[0])));
+		const __m128 dy(_mm_sub_ps(py, _mm_set1_ps(p.eye[1])));
+		const __m128 dz(_mm_sub_ps(pz, _mm_set1_ps(p.eye[2])));
+		__m128 ahead(_mm_mul_ps(dx, _mm_set1_ps(p.dir[0])));
+		ahead = _mm_add_ps(ahead, _mm_mul_ps(dy, _mm_set1_ps(p.dir[1])));
+		ahead = _mm_add_ps(ahead, _mm_mul_ps(dz, _mm_set1_ps(p.dir[2])));
+		__m128 dist(_mm_mul_ps(dx, dx));
+		dist = _mm_add_ps(dist, _mm_mul_ps(dy, dy));
+		dist = _mm_add_ps(dist, _mm_mul_ps(dz, dz));
+		dist = _mm_sqrt_ps(dist);
+		const __m128 reach(_mm_loadu_ps(p.reach + i));
+		const __m128 fade(_mm_max_ps(_mm_setzero_ps(), _mm_div_ps(_mm_sub_ps(reach, dist), reach)));
+		const __m128 a(_mm_mul_ps(_mm_loadu_ps(p.gain + i), fade));
+		_mm_storeu_ps(alpha + i, _mm_and_ps(_mm_cmpgt_ps(ahead, _mm_set1_ps(1.0f)), a));
+	}
+	projectScalar(p, i, last, sx, sy, alpha);
+}
+#endif
+
+
+#ifdef FLARELIGHTS_NEON
+static void projectNEON(const flareProjection &p, unsigned int last, float* sx, float* sy, float* alpha){
+	unsigned int i(0);
+	for(; i+4<=last; i+=4){
+		const float32x4_t px(vld1q_f32(p.x + i));
+		const float32x4_t py(vld1q_f32(p.y + i));
+		const float32x4_t pz(vld1q_f32(p.z + i));
+		float32x4_t cx(vmulq_f32(vdupq_n_f32(p.m[0]), px));
+		cx = vaddq_f32(cx, vmulq_f32(vdupq_n_f32(p.m[4]), py));
+		cx = vaddq_f32(cx, vmulq_f32(vdupq_n_f32(p.m[8]), pz));
+		cx = vaddq_f32(cx, vdupq_n_f32(p.m[12]));
+		float32x4_t cy(vmulq_f32(vdupq_n_f32(p.m[1]), px));
+		cy = vaddq_f32(cy, vmulq_f32(vdupq_n_f32(p.m[5]), py));
+		cy = vaddq_f32(cy, vmulq_f32(vdupq_n_f32(p.m[9]), pz));
+		cy = vaddq_f32(cy, vdupq_n_f32(p.m[13]));
+		float32x4_t cw(vmulq_f32(vdupq_n_f32(p.m[3]), px));
+		cw = vaddq_f32(cw, vmulq_f32(vdupq_n_f32(p.m[7]), py));
+		cw = vaddq_f32(cw, vmulq_f32(vdupq_n_f32(p.m[11]), pz));
+		cw = vaddq_f32(cw, vdupq_n_f32(p.m[15]));
+		vst1q_f32(sx + i, vaddq_f32(vdupq_n_f32(p.xOffset), vmulq_f32(vdupq_n_f32(p.xScale), vdivq_f32(cx, cw))));
+		vst1q_f32(sy + i, vaddq_f32(vdupq_n_f32(p.yOffset), vmulq_f32(vdupq_n_f32(p.yScale), vdivq_f32(cy, cw))));
+		const float32x4_t dx(vsubq_f32(px, vdupq_n_f32(p.eye[0])));
+		const float32x4_t dy(vsubq_f32(py, vdupq_n_f32(p.eye[1])));
+		const float32x4_t dz(vsubq_f32(pz, vdupq_n_f32(p.eye[2])));
+		float32x4_t ahead(vmulq_f32(dx, vdupq_n_f32(p.dir[0])));
+		ahead = vaddq_f32(ahead, vmulq_f32(dy, vdupq_n_f32(p.dir[1])));
+		ahead = vaddq_f32(ahead, vmulq_f32(dz, vdupq_n_f32(p.dir[2])));
+		float32x4_t dist(vmulq_f32(dx, dx));
+		dist = vaddq_f32(dist, vmulq_f32(dy, dy));
+		dist = vaddq_f32(dist, vmulq_f32(dz, dz));
+		dist = vsqrtq_f32(dist);
+		const float32x4_t reach(vld1q_f32(p.reach + i));
+		const float32x4_t fade(vmaxq_f32(vdupq_n_f32(0.0f), vdivq_f32(vsubq_f32(reach, dist), reach)));
+		const float32x4_t a(vmulq_f32(vld1q_f32(p.gain + i), fade));
+		const uint32x4_t front(vcgtq_f32(ahead, vdupq_n_f32(1.0f)));
+		vst1q_f32(alpha + i, vreinterpretq_f32_u32(vandq_u32(front, vreinterpretq_u32_f32(a))));
+	}
+	projectScalar(p, i, last, sx, sy, alpha);
+}
+#endif
+
+
+// Screen cell that a flare is clustered in, as one sortable number
+static long long clusterCell(const flareData &f){
+	const float limit(1000000.0f);  // lights nearly beside the camera can project very far out
+	const float cx(std::max(-limit, std::min(limit, f.x / FLARECLUSTER)));
+	const float cy(std::max(-limit, std::min(limit, f.y / FLARECLUSTER)));
+	return (long long)(floorf(cy)) * 4000000LL + (long long)(floorf(cx));
+}
+
+
+void flareLights::find(SkyrocketSaverSettings *inSettings){
+	flares.clear();
+	const float shine(float(inSettings->dFlare) * 0.01f);
+	const particleStore& store(inSettings->particles);
+	const unsigned int cap(store.capacity);
+	const float t(inSettings->kFireworks ? inSettings->tickFraction : 1.0f);
+
+	// Gather the lights.  Lights off the edge of the screen are kept because
+	// flare() fades their flares out over a margin past the edge.
+	x.clear();
+	y.clear();
+	z.clear();
+	gain.clear();
+	reach.clear();
+	projected.clear();
+	for(unsigned int i=0; i<inSettings->last_particle; ++i){
+		const unsigned int type(store.type[i]);
+		if(type != EXPLOSION && type != SUCKER && type != SHOCKWAVE
+			&& type != STRETCHER && type != BIGMAMA)
+			continue;
+		float pos[3];
+		for(int k=0; k<3; ++k){
+			pos[k] = store.xyz[k * cap + i];
+			if(t < 1.0f)
+				pos[k] = store.lastxyz[k * cap + i] + (pos[k] - store.lastxyz[k * cap + i]) * t;
+		}
+		x.push_back(pos[0]);
+		y.push_back(pos[1]);
+		z.push_back(pos[2]);
+		flareData f;
+		if(type == EXPLOSION){
+			f.r = store.rgb[i];
+			f.g = store.rgb[cap + i];
+			f.b = store.rgb[cap + cap + i];
+			gain.push_back(store.bright[i] * shine);
+			reach.push_back(10000.0f);
+		}
+		else{
+			f.r = f.g = f.b = 1.0f;
+			gain.push_back(store.bright[i] * 2.0f * shine);
+			reach.push_back(20000.0f);
+		}
+		projected.push_back(f);
+	}
+	const unsigned int count(projected.size());
+	if(!count)
+		return;
+
+	// project them
+	flareProjection p;
+	for(int r=0; r<4; ++r){
+		for(int c=0; c<4; ++c){
+			double sum(0.0);
+			for(int k=0; k<4; ++k)
+				sum += inSettings->projMat[k * 4 + r] * inSettings->modelMat[c * 4 + k];
+			p.m[c * 4 + r] = float(sum);
+		}
+	}
+	// same as gluProject() and then dividing by the window size, with x
+	// scaled so that the screen is aspectRatio wide
+	const int* viewport(inSettings->viewport);
+	p.xScale = 0.5f * float(viewport[2]) / float(inSettings->xsize) * inSettings->aspectRatio;
+	p.xOffset = (float(viewport[0]) + 0.5f * float(viewport[2])) / float(inSettings->xsize) * inSettings->aspectRatio;
+	p.yScale = 0.5f * float(viewport[3]) / float(inSettings->ysize);
+	p.yOffset = (float(viewport[1]) + 0.5f * float(viewport[3])) / float(inSettings->ysize);
+	rsVec dir(inSettings->lookAt[0] - inSettings->lookFrom[0]);
+	dir.normalize();
+	for(int k=0; k<3; ++k){
+		p.eye[k] = inSettings->cameraPos[k];
+		p.dir[k] = dir[k];
+	}
+	p.x = &x[0];
+	p.y = &y[0];
+	p.z = &z[0];
+	p.gain = &gain[0];
+	p.reach = &reach[0];
+	sx.resize(count);
+	sy.resize(count);
+	alpha.resize(count);
+	if(!inSettings->dSimd)
+		projectScalar(p, 0, count, &sx[0], &sy[0], &alpha[0]);
+	else{
+#if defined(FLARELIGHTS_SSE2)
+		projectSSE2(p, count, &sx[0], &sy[0], &alpha[0]);
+#elif defined(FLARELIGHTS_NEON)
+		projectNEON(p, count, &sx[0], &sy[0], &alpha[0]);
+#else
+		projectScalar(p, 0, count, &sx[0], &sy[0], &alpha[0]);
+#endif
+	}
+	order.clear();
+	for(unsigned int i=0; i<count; ++i){
+		projected[i].x = sx[i];
+		projected[i].y = sy[i];
+		projected[i].a = alpha[i];
+		if(alpha[i] > 0.0f)
+			order.push_back(i);
+	}
+
+	// Merge lights in the same screen cell.  A cluster sits at the
+	// alpha-weighted middle of its lights with their weighted color.  Its
+	// alpha is their sum, which is how bright they look added together, but
+	// never more than 1 unless one light alone was brighter.
+	std::stable_sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b){
+		return clusterCell(projected[a]) < clusterCell(projected[b]);
+	});
+	unsigned int first(0);
+	while(first < order.size()){
+		const long long cell(clusterCell(projected[order[first]]));
+		unsigned int last(first + 1);
+		while(last < order.size() && clusterCell(projected[order[last]]) == cell)
+			++last;
+		flareData c = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+		float brightest(0.0f);
+		for(unsigned int n=first; n<last; ++n){
+			const flareData& f(projected[order[n]]);
+			c.x += f.x * f.a;
+			c.y += f.y * f.a;
+			c.r += f.r * f.a;
+			c.g += f.g * f.a;
+			c.b += f.b * f.a;
+			c.a += f.a;
+			brightest = std::max(brightest, f.a);
+		}
+		const float weight(1.0f / c.a);
+		c.x *= weight;
+		c.y *= weight;
+		c.r *= weight;
+		c.g *= weight;
+		c.b *= weight;
+		c.a = std::min(c.a, std::max(brightest, 1.0f));
+		flares.push_back(c);
+		first = last;
+	}
+
+	// keep the brightest
+	std::stable_sort(flares.begin(), flares.end(), [](const flareData &a, const flareData &b){
+		return a.a > b.a;
+	});
+	if(inSettings->dMaxFlares > 0 && flares.size() > (unsigned int)(inSettings->dMaxFlares))
+		flares.resize(inSettings->dMaxFlares);
+}
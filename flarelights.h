@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef FLARELIGHTS_H
+#define FLARELIGHTS_H
+
+
+
+#include <vector>
+#include "flare.h"
+
+struct SkyrocketSaverSettings;
+
+
+// Lens flares from the lights in front of the camera (explosions, suckers,
+// shockwaves, stretchers, and big mamas), found once per drawn frame.  The lights are
+// projected onto the screen together with the frame's view-projection matrix,
+// four at a time where there is SIMD.  Lights that land close together on the
+// screen share one flare, and only the brightest dMaxFlares flares are kept,
+// so a big multi-break shell doesn't draw hundreds of them.
+class flareLights{
+public:
+	std::vector<flareData> flares;  // brightest first
+
+	// Find flares for the frame's particles, using modelMat and projMat from
+	// viewMatrices().  Not just the ones frustumCull found, because lights a
+	// little past the edge of the screen still make flares.
+	void find(SkyrocketSaverSettings *inSettings);
+
+private:
+	// lights, for the projection kernel
+	std::vector<float> x, y, z;  // where each light is drawn
+	std::vector<float> gain;  // flare alpha up close
+	std::vector<float> reach;  // distance at which the flare fades out
+	// what the projection kernel finds
+	std::vector<float> sx, sy;  // where each light is on the screen
+	std::vector<float> alpha;
+	std::vector<flareData> projected;
+	std::vector<unsigned int> order;
+};
+
+
+
+#endif
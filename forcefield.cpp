@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "forcefield.h"
+#include "particlegrid.h"
+#include "particle.h"
+#include "workerpool.h"
+#include <math.h>
+
+
+// Fewer particles than this per thread isn't worth waking the other threads for
+#define FORCEPERJOB 1000
+
+
+
+static float fieldReach(const forceField &field){
+	return field.kind == FORCE_PULL ? 500.0f : 800.0f;
+}
+
+
+void forceFields::add(int kind, const float* xyz, float strength){
+	forceField field;
+	field.kind = kind;
+	for(unsigned int j=0; j<3; ++j)
+		field.xyz[j] = xyz[j];
+	field.strength = strength;
+	fields.push_back(field);
+}
+
+
+void forceFields::apply(particleStore &inStore, const particleGrid &inGrid, workerPool* workers){
+	if(fields.empty())
+		return;
+
+	// sort fields into the cells they reach, keeping them in order
+	bins.sort(inGrid, fields, fieldReach);
+
+	store = &inStore;
+	grid = &inGrid;
+	inGrid.dealCells(workers, inGrid.numParticles, FORCEPERJOB, applyCell, this);
+}
+
+
+void forceFields::applyCell(unsigned int c, void* data){
+	forceFields* forces = (forceFields*)data;
+	const unsigned int* cellFields;
+	const unsigned int numFields(forces->bins.cellItems(c, cellFields));
+	if(numFields == 0)
+		return;
+
+	particleStore& store(*forces->store);
+	const particleGrid& grid(*forces->grid);
+	const unsigned int stride(store.capacity);
+	const float* x(store.xyz);
+	const float* y(store.xyz + stride);
+	const float* z(store.xyz + stride + stride);
+	float* vx(store.vel);
+	float* vy(store.vel + stride);
+	float* vz(store.vel + stride + stride);
+	const forceField* fields(&forces->fields[0]);
+
+	const unsigned int* parts;
+	const unsigned int numParts(grid.cellParticles(c, GRID_ALL, parts));
+	for(unsigned int p=0; p<numParts; ++p){
+		const unsigned int i(parts[p]);
+		const unsigned int type(store.type[i]);
+		// suckers and shockwaves don't move the field emitters
+		const bool pushable(type != SUCKER && type != STRETCHER
+			&& type != SHOCKWAVE && type != BIGMAMA);
+		float px(vx[i]), py(vy[i]), pz(vz[i]);
+		for(unsigned int n=0; n<numFields; ++n){
+			const forceField& field(fields[cellFields[n]]);
+			if(field.kind == FORCE_PULL){
+				const float dx(field.xyz[0] - x[i]);
+				const float dy(field.xyz[1] - y[i]);
+				const float dz(field.xyz[2] - z[i]);
+				const float distsquared(dx*dx + dy*dy + dz*dz);
+				if(distsquared < 250000.0f && distsquared != 0.0f && pushable){
+					const float normalizer(1.0f / sqrtf(distsquared));
+					const float pull((250000.0f - distsquared) * field.strength);
+					px += (dx * normalizer) * pull;
+					py += (dy * normalizer) * pull;
+					pz += (dz * normalizer) * pull;
+				}
+			}
+			else if(field.kind == FORCE_PUSH){
+				const float dx(x[i] - field.xyz[0]);
+				const float dy(y[i] - field.xyz[1]);
+				const float dz(z[i] - field.xyz[2]);
+				const float distsquared(dx*dx + dy*dy + dz*dz);
+				if(distsquared < 640000.0f && distsquared != 0.0f && pushable){
+					const float normalizer(1.0f / sqrtf(distsquared));
+					const float push((640000.0f - distsquared) * field.strength);
+					px += (dx * normalizer) * push;
+					py += (dy * normalizer) * push;
+					pz += (dz * normalizer) * push;
+				}
+			}
+			else{  // FORCE_STRETCH
+				const float dx(field.xyz[0] - x[i]);
+				const float dy(field.xyz[1] - y[i]);
+				const float dz(field.xyz[2] - z[i]);
+				const float distsquared(dx*dx + dy*dy + dz*dz);
+				if(distsquared < 640000.0f && distsquared != 0.0f && type != STRETCHER){
+					const float normalizer(1.0f / sqrtf(distsquared));
+					const float temp((640000.0f - distsquared) * field.strength);
+					px += (dx * normalizer) * temp * 5.0f;
+					py -= (dy * normalizer) * temp;
+					pz += (dz * normalizer) * temp * 5.0f;
+				}
+			}
+		}
+		vx[i] = px;
+		vy[i] = py;
+		vz[i] = pz;
+	}
+}
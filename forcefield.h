@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef FORCEFIELD_H
+#define FORCEFIELD_H
+
+
+
+#include "particlegrid.h"
+#include <vector>
+
+class workerPool;
+
+
+// Kinds of force field
+#define FORCE_PULL 0  // suckers pull particles in
+#define FORCE_PUSH 1  // shockwaves push particles out
+#define FORCE_STRETCH 2  // stretchers pull in sideways and push out vertically
+
+
+// A sucker, shockwave, or stretcher acting on other particles this frame
+struct forceField{
+	int kind;
+	float xyz[3];
+	float strength;  // falloff times frameTime; grows as the field ages
+};
+
+
+// Applies all force fields in one pass:  every particle adds up the fields
+// that reach it, in the order they were added, so each particle's velocity is
+// written by exactly one thread.  Fields are collected during the frame with
+// add() and sorted into the grid's cells so that particles only look at
+// fields near them.
+class forceFields{
+public:
+	std::vector<forceField> fields;
+
+	void clear() {fields.clear();}
+	void add(int kind, const float* xyz, float strength);
+	// Change the velocity of every particle in grid, which must be up to date
+	// for store.  Uses the worker threads when there are enough particles.
+	void apply(particleStore &store, const particleGrid &grid, workerPool* workers);
+
+private:
+	cellBins bins;  // fields sorted into the cells they reach
+	// for applyCell()
+	particleStore* store;
+	const particleGrid* grid;
+
+	static void applyCell(unsigned int c, void* data);
+};
+
+
+
+#endif
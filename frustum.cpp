@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "frustum.h"
+#include "particle.h"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#define FRUSTUM_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define FRUSTUM_NEON
+#include <arm_neon.h>
+#endif
+
+
+
+// Where particles are drawn and how big they are
+struct cullInput{
+	const unsigned int* type;
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* lx;
+	const float* ly;
+	const float* lz;
+	const float* size;
+	float t;
+};
+
+
+// Reference version.  The SIMD kernels do the same operations in the same order.
+static void cullScalar(const float planes[6][4], const cullInput &in, unsigned int first, unsigned int last, unsigned char* inView){
+	const bool lerp(in.t < 1.0f);
+	for(unsigned int i=first; i<last; ++i){
+		float px(in.x[i]), py(in.y[i]), pz(in.z[i]);
+		if(lerp){
+			px = in.lx[i] + (px - in.lx[i]) * in.t;
+			py = in.ly[i] + (py - in.ly[i]) * in.t;
+			pz = in.lz[i] + (pz - in.lz[i]) * in.t;
+		}
+		const float radius(-in.size[i]);
+		unsigned char inside(1);
+		for(int p=0; p<6; ++p){
+			const float dist(planes[p][0] * px + planes[p][1] * py + planes[p][2] * pz + planes[p][3]);
+			if(dist <= radius)
+				inside = 0;
+		}
+		inView[i] = inside | (in.type[i] == SHOCKWAVE ? 1 : 0);
+	}
+}
+
+
+#ifdef FRUSTUM_SSE2
+static void cullSSE2(const float planes[6][4], const cullInput &in, unsigned int last, unsigned char* inView){
+	const bool lerp(in.t < 1.0f);
+	const __m128 t(_mm_set1_ps(in.t));
+	const __m128i shockwave(_mm_set1_epi32(SHOCKWAVE));
+	unsigned int i(0);
+	for(; i+4<=last; i+=4){
+		__m128 px(_mm_loadu_ps(in.x + i));
+		__m128 py(_mm_loadu_ps(in.y + i));
+		__m128 pz(_mm_loadu_ps(in.z + i));
+		if(lerp){
+			const __m128 lx(_mm_loadu_ps(in.lx + i));
+			const __m128 ly(_mm_loadu_ps(in.ly + i));
+			const __m128 lz(_mm_loadu_ps(in.lz + i));
+			px = _mm_add_ps(lx, _mm_mul_ps(_mm_sub_ps(px, lx), t));
+			py = _mm_add_ps(ly, _mm_mul_ps(_mm_sub_ps(py, ly), t));
+			pz = _mm_add_ps(lz, _mm_mul_ps(_mm_sub_ps(pz, lz), t));
+		}
+		const __m128 radius(_mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(in.size + i)));
+		__m128 inside(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(in.type + i)), shockwave)));
+		__m128 outside(_mm_setzero_ps());
+		for(int p=0; p<6; ++p){
+			__m128 dist(_mm_mul_ps(_mm_set1_ps(planes[p][0]), px));
+			dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(planes[p][1]), py));
+			dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(planes[p][2]), pz));
+			dist = _mm_add_ps(dist, _mm_set1_ps(planes[p][3]));
+			outside = _mm_or_ps(outside, _mm_cmple_ps(dist, radius));
+		}
+		inside = _mm_or_ps(inside, _mm_andnot_ps(outside, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+		const int mask(_mm_movemask_ps(inside));
+		inView[i] = mask & 1;
+		inView[i + 1] = (mask >> 1) & 1;
+		inView[i + 2] = (mask >> 2) & 1;
+		inView[i + 3] = (mask >> 3) & 1;
+	}
+	cullScalar(planes, in, i, last, inView);
+}
+#endif
+
+
+#ifdef FRUSTUM_NEON
+static void cullNEON(const float planes[6][4], const cullInput &in, unsigned int last, unsigned char* inView){
+	const bool lerp(in.t < 1.0f);
+	const float32x4_t t(vdupq_n_f32(in.t));
+	const uint32x4_t shockwave(vdupq_n_u32(SHOCKWAVE));
+	unsigned int i(0);
+	for(; i+4<=last; i+=4){
+		float32x4_t px(vld1q_f32(in.x + i));
+		float32x4_t py(vld1q_f32(in.y + i));
+		float32x4_t pz(vld1q_f32(in.z + i));
+		if(lerp){
+			const float32x4_t lx(vld1q_f32(in.lx + i));
+			const float32x4_t ly(vld1q_f32(in.ly + i));
+			const float32x4_t lz(vld1q_f32(in.lz + i));
+			px = vaddq_f32(lx, vmulq_f32(vsubq_f32(px, lx), t));
+			py = vaddq_f32(ly, vmulq_f32(vsubq_f32(py, ly), t));
+			pz = vaddq_f32(lz, vmulq_f32(vsubq_f32(pz, lz), t));
+		}
+		const float32x4_t radius(vnegq_f32(vld1q_f32(in.size + i)));
+		const uint32x4_t isShockwave(vceqq_u32(vld1q_u32(in.type + i), shockwave));
+		uint32x4_t outside(vdupq_n_u32(0));
+		for(int p=0; p<6; ++p){
+			float32x4_t dist(vmulq_f32(vdupq_n_f32(planes[p][0]), px));
+			dist = vaddq_f32(dist, vmulq_f32(vdupq_n_f32(planes[p][1]), py));
+			dist = vaddq_f32(dist, vmulq_f32(vdupq_n_f32(planes[p][2]), pz));
+			dist = vaddq_f32(dist, vdupq_n_f32(planes[p][3]));
+			outside = vorrq_u32(outside, vcleq_f32(dist, radius));
+		}
+		const uint32x4_t inside(vorrq_u32(isShockwave, vmvnq_u32(outside)));
+		inView[i] = vgetq_lane_u32(inside, 0) & 1;
+		inView[i + 1] = vgetq_lane_u32(inside, 1) & 1;
+		inView[i + 2] = vgetq_lane_u32(inside, 2) & 1;
+		inView[i + 3] = vgetq_lane_u32(inside, 3) & 1;
+	}
+	cullScalar(planes, in, i, last, inView);
+}
+#endif
+
+
+void frustumCull::cull(const particleStore &store, unsigned int count, const double* modelMat,
+	const double* projMat, float t, int useSimd){
+	// Rows of projMat * modelMat give the planes (Gribb and Hartmann):
+	// left, right, bottom, top, near, far.  Points inside have positive distances.
+	double clip[4][4];  // clip[row][column]
+	for(int r=0; r<4; ++r){
+		for(int c=0; c<4; ++c){
+			clip[r][c] = 0.0;
+			for(int k=0; k<4; ++k)
+				clip[r][c] += projMat[k * 4 + r] * modelMat[c * 4 + k];
+		}
+	}
+	float planes[6][4];
+	for(int p=0; p<6; ++p){
+		const int row(p / 2);
+		const double sign(p & 1 ? -1.0 : 1.0);
+		double plane[4];
+		for(int c=0; c<4; ++c)
+			plane[c] = clip[3][c] + sign * clip[row][c];
+		const double len(sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]));
+		for(int c=0; c<4; ++c)
+			planes[p][c] = float(plane[c] / len);
+	}
+
+	const unsigned int cap(store.capacity);
+	cullInput in;
+	in.type = store.type;
+	in.x = store.xyz;
+	in.y = in.x + cap;
+	in.z = in.y + cap;
+	in.lx = store.lastxyz;
+	in.ly = in.lx + cap;
+	in.lz = in.ly + cap;
+	in.size = store.size;
+	in.t = t;
+
+	inView.resize(count);
+	unsigned char* mask(count ? &inView[0] : NULL);
+	if(!useSimd)
+		cullScalar(planes, in, 0, count, mask);
+	else{
+#if defined(FRUSTUM_SSE2)
+		cullSSE2(planes, in, count, mask);
+#elif defined(FRUSTUM_NEON)
+		cullNEON(planes, in, count, mask);
+#else
+		cullScalar(planes, in, 0, count, mask);
+#endif
+	}
+
+	visible.clear();
+	for(unsigned int i=0; i<count; ++i){
+		if(mask[i])
+			visible.push_back(i);
+	}
+}
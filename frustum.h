@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+
+
+#include <vector>
+
+class particleStore;
+
+
+// Finds the particles that can be seen from the camera, once per drawn frame,
+// so that drawing only has to look at those.  Each particle's bounding sphere
+// (where it is drawn, and its size) is tested against the six sides of the
+// view frustum, four particles at a time where there is SIMD.
+// Shockwaves are always kept because their rings reach far past their size.
+class frustumCull{
+public:
+	std::vector<unsigned int> visible;  // particles in view, in particle order
+	std::vector<unsigned char> inView;  // 1 for each particle in view, 0 otherwise
+
+	// Cull the first count particles of store against projMat * modelMat
+	// (OpenGL's column-major order).  Particles are drawn t of the way from
+	// lastxyz to xyz (see stepSim()); pass 1 to use xyz.
+	void cull(const particleStore &store, unsigned int count, const double* modelMat,
+		const double* projMat, float t, int useSimd);
+};
+
+
+
+#endif
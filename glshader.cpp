@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <stddef.h>
+#include "glshader.h"
+
+
+
+static GLuint compileShader(GLenum type, const char* source){
+	GLuint shader(glCreateShader(type));
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint ok(GL_FALSE);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if(ok != GL_TRUE){
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+
+unsigned int linkShaderProgram(const char* vertexSource, const char* fragmentSource,
+	const shaderAttrib* attribs, int numAttribs){
+	GLuint vertex(0);
+	if(vertexSource){
+		vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+		if(!vertex)
+			return 0;
+	}
+	GLuint fragment(compileShader(GL_FRAGMENT_SHADER, fragmentSource));
+	if(!fragment){
+		if(vertex)
+			glDeleteShader(vertex);
+		return 0;
+	}
+	GLuint program(glCreateProgram());
+	if(vertex)
+		glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	for(int i=0; i<numAttribs; ++i)
+		glBindAttribLocation(program, attribs[i].location, attribs[i].name);
+	glLinkProgram(program);
+	// the program keeps what it needs
+	if(vertex)
+		glDeleteShader(vertex);
+	glDeleteShader(fragment);
+	GLint ok(GL_FALSE);
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if(ok != GL_TRUE){
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef GLSHADER_H
+#define GLSHADER_H
+
+
+
+// A vertex attribute to bind to a location before linking
+struct shaderAttrib{
+	unsigned int location;
+	const char* name;
+};
+
+
+// Compile and link a GLSL program.  vertexSource may be NULL for the fixed
+// function vertex pipeline.  The numAttribs attribs are bound before linking.
+// Returns 0 if anything fails to compile or link.
+unsigned int linkShaderProgram(const char* vertexSource, const char* fragmentSource,
+	const shaderAttrib* attribs = 0, int numAttribs = 0);
+
+
+
+#endif
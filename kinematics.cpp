@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "kinematics.h"
+#include "particle.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KINEMATICS_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define KINEMATICS_ARM
+#include <arm_neon.h>
+#endif
+
+
+typedef void (*kinematicsFunc)(particleStore&, unsigned int, unsigned int, float, float);
+
+static kinematicsFunc kinematicsKernel = NULL;
+static int kinematicsType = KINEMATICS_SCALAR;
+
+
+
+// Reference version.  The SIMD kernels below do exactly these operations in
+// exactly this order so that they round the same way.
+static void integrateScalar(particleStore& store, unsigned int first, unsigned int last, float frameTime, float wind){
+	const unsigned int cap(store.capacity);
+	const float gravity(frameTime * 32.0f);
+	const unsigned int* type(store.type);
+	float* x(store.xyz);
+	float* y(x + cap);
+	float* z(y + cap);
+	float* lx(store.lastxyz);
+	float* ly(lx + cap);
+	float* lz(ly + cap);
+	float* vx(store.vel);
+	float* vy(vx + cap);
+	float* vz(vy + cap);
+	const float* drag(store.drag);
+
+	for(unsigned int i=first; i<last; ++i){
+		if(type[i] != SMOKE)
+			vy[i] -= gravity;
+		// apply air resistance
+		float temp(1.0f / (1.0f + drag[i] * frameTime));
+		temp *= temp;
+		vx[i] *= temp;
+		vy[i] *= temp;
+		vz[i] *= temp;
+
+		// update position
+		// (Fountains don't move)
+		if(type[i] != FOUNTAIN){
+			lx[i] = x[i];
+			ly[i] = y[i];
+			lz[i] = z[i];
+			x[i] += vx[i] * frameTime;
+			y[i] += vy[i] * frameTime;
+			z[i] += vz[i] * frameTime;
+			// Wind:  1/10 wind on ground; -1/2 wind at 500 feet; full wind at 2000 feet;
+			// This value is calculated to coincide with movement of the clouds in world.h
+			// Here's the polynomial wind equation that simulates windshear:
+			x[i] += (0.1f - 0.00175f * y[i] + 0.0000011f * y[i] * y[i]) * wind * frameTime;
+		}
+	}
+}
+
+
+#ifdef KINEMATICS_X86
+static void integrateSSE2(particleStore& store, unsigned int first, unsigned int last, float frameTime, float wind){
+	const unsigned int cap(store.capacity);
+	const unsigned int* type(store.type);
+	float* x(store.xyz);
+	float* y(x + cap);
+	float* z(y + cap);
+	float* lx(store.lastxyz);
+	float* ly(lx + cap);
+	float* lz(ly + cap);
+	float* vx(store.vel);
+	float* vy(vx + cap);
+	float* vz(vy + cap);
+	const float* drag(store.drag);
+
+	const __m128 ft(_mm_set1_ps(frameTime));
+	const __m128 gravity(_mm_set1_ps(frameTime * 32.0f));
+	const __m128 windv(_mm_set1_ps(wind));
+	const __m128 one(_mm_set1_ps(1.0f));
+	const __m128 w0(_mm_set1_ps(0.1f));
+	const __m128 w1(_mm_set1_ps(0.00175f));
+	const __m128 w2(_mm_set1_ps(0.0000011f));
+	const __m128i smoke(_mm_set1_epi32(SMOKE));
+	const __m128i fountain(_mm_set1_epi32(FOUNTAIN));
+
+	unsigned int i(first);
+	for(; i+4<=last; i+=4){
+		const __m128i t(_mm_loadu_si128((const __m128i*)(type + i)));
+		const __m128 isSmoke(_mm_castsi128_ps(_mm_cmpeq_epi32(t, smoke)));
+		const __m128 isFountain(_mm_castsi128_ps(_mm_cmpeq_epi32(t, fountain)));
+
+		__m128 velx(_mm_loadu_ps(vx + i));
+		__m128 vely(_mm_loadu_ps(vy + i));
+		__m128 velz(_mm_loadu_ps(vz + i));
+		vely = _mm_sub_ps(vely, _mm_andnot_ps(isSmoke, gravity));
+		__m128 temp(_mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(drag + i), ft))));
+		temp = _mm_mul_ps(temp, temp);
+		velx = _mm_mul_ps(velx, temp);
+		vely = _mm_mul_ps(vely, temp);
+		velz = _mm_mul_ps(velz, temp);
+		_mm_storeu_ps(vx + i, velx);
+		_mm_storeu_ps(vy + i, vely);
+		_mm_storeu_ps(vz + i, velz);
+
+		const __m128 posx(_mm_loadu_ps(x + i));
+		const __m128 posy(_mm_loadu_ps(y + i));
+		const __m128 posz(_mm_loadu_ps(z + i));
+		__m128 newx(_mm_add_ps(posx, _mm_mul_ps(velx, ft)));
+		const __m128 newy(_mm_add_ps(posy, _mm_mul_ps(vely, ft)));
+		const __m128 newz(_mm_add_ps(posz, _mm_mul_ps(velz, ft)));
+		const __m128 shear(_mm_add_ps(_mm_sub_ps(w0, _mm_mul_ps(w1, newy)), _mm_mul_ps(_mm_mul_ps(w2, newy), newy)));
+		newx = _mm_add_ps(newx, _mm_mul_ps(_mm_mul_ps(shear, windv), ft));
+
+		// fountains keep their old position and lastxyz
+		_mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(isFountain, posx), _mm_andnot_ps(isFountain, newx)));
+		_mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(isFountain, posy), _mm_andnot_ps(isFountain, newy)));
+		_mm_storeu_ps(z + i, _mm_or_ps(_mm_and_ps(isFountain, posz), _mm_andnot_ps(isFountain, newz)));
+		_mm_storeu_ps(lx + i, _mm_or_ps(_mm_and_ps(isFountain, _mm_loadu_ps(lx + i)), _mm_andnot_ps(isFountain, posx)));
+		_mm_storeu_ps(ly + i, _mm_or_ps(_mm_and_ps(isFountain, _mm_loadu_ps(ly + i)), _mm_andnot_ps(isFountain, posy)));
+		_mm_storeu_ps(lz + i, _mm_or_ps(_mm_and_ps(isFountain, _mm_loadu_ps(lz + i)), _mm_andnot_ps(isFountain, posz)));
+	}
+	integrateScalar(store, i, last, frameTime, wind);
+}
+
+
+__attribute__((target("avx2")))
+static void integrateAVX2(particleStore& store, unsigned int first, unsigned int last, float frameTime, float wind){
+	const unsigned int cap(store.capacity);
+	const unsigned int* type(store.type);
+	float* x(store.xyz);
+	float* y(x + cap);
+	float* z(y + cap);
+	float* lx(store.lastxyz);
+	float* ly(lx + cap);
+	float* lz(ly + cap);
+	float* vx(store.vel);
+	float* vy(vx + cap);
+	float* vz(vy + cap);
+	const float* drag(store.drag);
+
+	const __m256 ft(_mm256_set1_ps(frameTime));
+	const __m256 gravity(_mm256_set1_ps(frameTime * 32.0f));
+	const __m256 windv(_mm256_set1_ps(wind));
+	const __m256 one(_mm256_set1_ps(1.0f));
+	const __m256 w0(_mm256_set1_ps(0.1f));
+	const __m256 w1(_mm256_set1_ps(0.00175f));
+	const __m256 w2(_mm256_set1_ps(0.0000011f));
+	const __m256i smoke(_mm256_set1_epi32(SMOKE));
+	const __m256i fountain(_mm256_set1_epi32(FOUNTAIN));
+
+	unsigned int i(first);
+	for(; i+8<=last; i+=8){
+		const __m256i t(_mm256_loadu_si256((const __m256i*)(type + i)));
+		const __m256 isSmoke(_mm256_castsi256_ps(_mm256_cmpeq_epi32(t, smoke)));
+		const __m256 isFountain(_mm256_castsi256_ps(_mm256_cmpeq_epi32(t, fountain)));
+
+		__m256 velx(_mm256_loadu_ps(vx + i));
+		__m256 vely(_mm256_loadu_ps(vy + i));
+		__m256 velz(_mm256_loadu_ps(vz + i));
+		vely = _mm256_sub_ps(vely, _mm256_andnot_ps(isSmoke, gravity));
+		__m256 temp(_mm256_div_ps(one, _mm256_add_ps(one, _mm256_mul_ps(_mm256_loadu_ps(drag + i), ft))));
+		temp = _mm256_mul_ps(temp, temp);
+		velx = _mm256_mul_ps(velx, temp);
+		vely = _mm256_mul_ps(vely, temp);
+		velz = _mm256_mul_ps(velz, temp);
+		_mm256_storeu_ps(vx + i, velx);
+		_mm256_storeu_ps(vy + i, vely);
+		_mm256_storeu_ps(vz + i, velz);
+
+		const __m256 posx(_mm256_loadu_ps(x + i));
+		const __m256 posy(_mm256_loadu_ps(y + i));
+		const __m256 posz(_mm256_loadu_ps(z + i));
+		__m256 newx(_mm256_add_ps(posx, _mm256_mul_ps(velx, ft)));
+		const __m256 newy(_mm256_add_ps(posy, _mm256_mul_ps(vely, ft)));
+		const __m256 newz(_mm256_add_ps(posz, _mm256_mul_ps(velz, ft)));
+		const __m256 shear(_mm256_add_ps(_mm256_sub_ps(w0, _mm256_mul_ps(w1, newy)), _mm256_mul_ps(_mm256_mul_ps(w2, newy), newy)));
+		newx = _mm256_add_ps(newx, _mm256_mul_ps(_mm256_mul_ps(shear, windv), ft));
+
+		// fountains keep their old position and lastxyz
+		_mm256_storeu_ps(x + i, _mm256_blendv_ps(newx, posx, isFountain));
+		_mm256_storeu_ps(y + i, _mm256_blendv_ps(newy, posy, isFountain));
+		_mm256_storeu_ps(z + i, _mm256_blendv_ps(newz, posz, isFountain));
+		_mm256_storeu_ps(lx + i, _mm256_blendv_ps(posx, _mm256_loadu_ps(lx + i), isFountain));
+		_mm256_storeu_ps(ly + i, _mm256_blendv_ps(posy, _mm256_loadu_ps(ly + i), isFountain));
+		_mm256_storeu_ps(lz + i, _mm256_blendv_ps(posz, _mm256_loadu_ps(lz + i), isFountain));
+	}
+	integrateSSE2(store, i, last, frameTime, wind);
+}
+#endif
+
+
+#ifdef KINEMATICS_ARM
+static void integrateNEON(particleStore& store, unsigned int first, unsigned int last, float frameTime, float wind){
+	const unsigned int cap(store.capacity);
+	const unsigned int* type(store.type);
+	float* x(store.xyz);
+	float* y(x + cap);
+	float* z(y + cap);
+	float* lx(store.lastxyz);
+	float* ly(lx + cap);
+	float* lz(ly + cap);
+	float* vx(store.vel);
+	float* vy(vx + cap);
+	float* vz(vy + cap);
+	const float* drag(store.drag);
+
+	const float32x4_t ft(vdupq_n_f32(frameTime));
+	const float32x4_t gravity(vdupq_n_f32(frameTime * 32.0f));
+	const float32x4_t windv(vdupq_n_f32(wind));
+	const float32x4_t one(vdupq_n_f32(1.0f));
+	const float32x4_t w0(vdupq_n_f32(0.1f));
+	const float32x4_t w1(vdupq_n_f32(0.00175f));
+	const float32x4_t w2(vdupq_n_f32(0.0000011f));
+	const uint32x4_t smoke(vdupq_n_u32(SMOKE));
+	const uint32x4_t fountain(vdupq_n_u32(FOUNTAIN));
+
+	// Separate vmulq/vaddq (not vfmaq/vmlaq) so rounding matches the scalar code
+	unsigned int i(first);
+	for(; i+4<=last; i+=4){
+		const uint32x4_t t(vld1q_u32(type + i));
+		const uint32x4_t isSmoke(vceqq_u32(t, smoke));
+		const uint32x4_t isFountain(vceqq_u32(t, fountain));
+
+		float32x4_t velx(vld1q_f32(vx + i));
+		float32x4_t vely(vld1q_f32(vy + i));
+		float32x4_t velz(vld1q_f32(vz + i));
+		vely = vsubq_f32(vely, vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(gravity), isSmoke)));
+		float32x4_t temp(vdivq_f32(one, vaddq_f32(one, vmulq_f32(vld1q_f32(drag + i), ft))));
+		temp = vmulq_f32(temp, temp);
+		velx = vmulq_f32(velx, temp);
+		vely = vmulq_f32(vely, temp);
+		velz = vmulq_f32(velz, temp);
+		vst1q_f32(vx + i, velx);
+		vst1q_f32(vy + i, vely);
+		vst1q_f32(vz + i, velz);
+
+		const float32x4_t posx(vld1q_f32(x + i));
+		const float32x4_t posy(vld1q_f32(y + i));
+		const float32x4_t posz(vld1q_f32(z + i));
+		float32x4_t newx(vaddq_f32(posx, vmulq_f32(velx, ft)));
+		const float32x4_t newy(vaddq_f32(posy, vmulq_f32(vely, ft)));
+		const float32x4_t newz(vaddq_f32(posz, vmulq_f32(velz, ft)));
+		const float32x4_t shear(vaddq_f32(vsubq_f32(w0, vmulq_f32(w1, newy)), vmulq_f32(vmulq_f32(w2, newy), newy)));
+		newx = vaddq_f32(newx, vmulq_f32(vmulq_f32(shear, windv), ft));
+
+		// fountains keep their old position and lastxyz
+		vst1q_f32(x + i, vbslq_f32(isFountain, posx, newx));
+		vst1q_f32(y + i, vbslq_f32(isFountain, posy, newy));
+		vst1q_f32(z + i, vbslq_f32(isFountain, posz, newz));
+		vst1q_f32(lx + i, vbslq_f32(isFountain, vld1q_f32(lx + i), posx));
+		vst1q_f32(ly + i, vbslq_f32(isFountain, vld1q_f32(ly + i), posy));
+		vst1q_f32(lz + i, vbslq_f32(isFountain, vld1q_f32(lz + i), posz));
+	}
+	integrateScalar(store, i, last, frameTime, wind);
+}
+#endif
+
+
+
+int chooseKinematics(int useSimd){
+	kinematicsKernel = integrateScalar;
+	kinematicsType = KINEMATICS_SCALAR;
+	if(!useSimd)
+		return kinematicsType;
+
+#ifdef KINEMATICS_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")){
+		kinematicsKernel = integrateAVX2;
+		kinematicsType = KINEMATICS_AVX2;
+	}
+	else if(__builtin_cpu_supports("sse2")){
+		kinematicsKernel = integrateSSE2;
+		kinematicsType = KINEMATICS_SSE2;
+	}
+#endif
+#ifdef KINEMATICS_ARM
+	// NEON is always there on 64-bit ARM
+	kinematicsKernel = integrateNEON;
+	kinematicsType = KINEMATICS_NEON;
+#endif
+
+	return kinematicsType;
+}
+
+
+const char* kinematicsName(){
+	static const char* names[4] = {"scalar", "SSE2", "AVX2", "NEON"};
+	return names[kinematicsType];
+}
+
+
+void integrateParticles(particleStore& store, unsigned int first, unsigned int last, float frameTime, float wind){
+	if(!kinematicsKernel)
+		chooseKinematics(1);
+	kinematicsKernel(store, first, last, frameTime, wind);
+}
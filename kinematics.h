@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+
+
+#include "particlestore.h"
+
+
+// Which version of integrateParticles() to use
+#define KINEMATICS_SCALAR 0
+#define KINEMATICS_SSE2 1
+#define KINEMATICS_AVX2 2
+#define KINEMATICS_NEON 3
+
+
+// Pick the fastest kernel this CPU supports, or the plain C++ one if
+// useSimd is 0.  Returns one of the KINEMATICS_ values.
+int chooseKinematics(int useSimd);
+const char* kinematicsName();
+
+// Apply gravity (except to smoke), air resistance, movement (except for
+// fountains) and wind to particles first through last-1.  This is the part
+// of a particle's update that is the same for every type of particle.
+// The SIMD kernels give the same results as the scalar one, give or take
+// floating point contraction by the compiler (within 1e-6 relative error).
+void integrateParticles(particleStore& store, unsigned int first, unsigned int last,
+	float frameTime, float wind);
+
+
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <string.h>
+#include "lensflare.h"
+#include "glshader.h"
+
+
+
+// The targets are this many times smaller than the screen on each side
+#define LENSFLARE_DOWNSAMPLE 8
+// The bright layer is mostly small points, so it needs more gain than a
+// flare sprite to look as bright
+#define LENSFLARE_GAIN 6.0f
+
+
+// Ghosts are copies of the bright layer turned half way around the middle of
+// the screen and spaced along the line through it, each a little bigger and
+// tinted toward blue the further out it sits.  They fade toward the edges of
+// the screen, where the real lenses would cut them off.  The halo is a ring
+// that catches whatever is on the far side of the middle, in the direction of
+// each pixel.  Every sample is four taps two texels apart to soften it.
+static const char* flareFragmentShader =
+	"#version 120\n"
+	"uniform sampler2D brightTex;\n"
+	"uniform vec2 texel;\n"
+	"uniform float aspect;\n"
+	"uniform float intensity;\n"
+	"vec3 soft(vec2 st){\n"
+	"	return 0.25 * (texture2D(brightTex, st + texel * 2.0).rgb\n"
+	"		+ texture2D(brightTex, st - texel * 2.0).rgb\n"
+	"		+ texture2D(brightTex, st + vec2(texel.x, -texel.y) * 1.5).rgb\n"
+	"		+ texture2D(brightTex, st + vec2(-texel.x, texel.y) * 1.5).rgb);\n"
+	"}\n"
+	"float edgeFade(vec2 st){\n"
+	"	vec2 fromMiddle = (st - 0.5) * vec2(aspect, 1.0);\n"
+	"	return pow(max(1.0 - length(fromMiddle), 0.0), 2.0);\n"
+	"}\n"
+	"void main(){\n"
+	"	vec2 st = vec2(1.0) - gl_TexCoord[0].st;\n"
+	"	vec2 ghostStep = (vec2(0.5) - st) * 0.45;\n"
+	"	vec3 sum = vec3(0.0);\n"
+	"	for(int i=0; i<5; ++i){\n"
+	"		vec2 at = st + ghostStep * float(i);\n"
+	"		vec3 tint = mix(vec3(1.0, 0.75, 0.5), vec3(0.5, 0.7, 1.0), float(i) * 0.25);\n"
+	"		sum += soft(at) * tint * edgeFade(at);\n"
+	"	}\n"
+	"	vec2 toMiddle = (vec2(0.5) - st) * vec2(aspect, 1.0);\n"
+	"	float fromMiddle = length(toMiddle);\n"
+	"	vec2 haloAt = st + toMiddle / max(fromMiddle, 1e-4) * vec2(1.0 / aspect, 1.0) * 0.35;\n"
+	"	float ring = pow(max(1.0 - abs(fromMiddle - 0.35) * 5.0, 0.0), 2.0);\n"
+	"	sum += soft(haloAt) * vec3(0.8, 0.9, 1.0) * ring;\n"
+	"	gl_FragColor = vec4(sum * intensity, 1.0);\n"
+	"}\n";
+
+static GLuint flareFramebuffer[2] = {0, 0};  // bright layer, flares
+static GLuint flareTex[2] = {0, 0};
+static GLuint flareProgram = 0;
+static GLint texelUniform = -1;
+static GLint intensityUniform = -1;
+static int flareWidth, flareHeight;
+static GLint aspectUniform = -1;
+// where the frame is drawn, recorded by initLensFlare() and resizeLensFlare()
+static GLint defaultFramebuffer = 0;
+static GLint defaultViewport[4];
+
+
+
+// One quad over the whole target
+static void drawScreenQuad(){
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glBegin(GL_TRIANGLE_STRIP);
+		glTexCoord2f(0.0f, 0.0f);
+		glVertex2f(-1.0f, -1.0f);
+		glTexCoord2f(1.0f, 0.0f);
+		glVertex2f(1.0f, -1.0f);
+		glTexCoord2f(0.0f, 1.0f);
+		glVertex2f(-1.0f, 1.0f);
+		glTexCoord2f(1.0f, 1.0f);
+		glVertex2f(1.0f, 1.0f);
+	glEnd();
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+}
+
+
+int initLensFlare(int width, int height){
+	const char* extensions((const char*)glGetString(GL_EXTENSIONS));
+	if(!extensions || !strstr(extensions, "GL_EXT_framebuffer_object"))
+		return 0;
+
+	// the fixed function vertex pipeline hands the shader its texture coordinates
+	flareProgram = linkShaderProgram(NULL, flareFragmentShader);
+	if(!flareProgram)
+		return 0;
+	glUseProgram(flareProgram);
+	glUniform1i(glGetUniformLocation(flareProgram, "brightTex"), 0);
+	aspectUniform = glGetUniformLocation(flareProgram, "aspect");
+	texelUniform = glGetUniformLocation(flareProgram, "texel");
+	intensityUniform = glGetUniformLocation(flareProgram, "intensity");
+	glUseProgram(0);
+
+	// Linear filtering smooths the ghosts' samples and blows the flares back
+	// up to the size of the screen
+	glGenTextures(2, flareTex);
+	for(int i=0; i<2; ++i){
+		glBindTexture(GL_TEXTURE_2D, flareTex[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	resizeLensFlare(width, height);
+
+	glGenFramebuffersEXT(2, flareFramebuffer);
+	GLenum status(GL_FRAMEBUFFER_COMPLETE_EXT);
+	for(int i=0; i<2 && status == GL_FRAMEBUFFER_COMPLETE_EXT; ++i){
+		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, flareFramebuffer[i]);
+		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, flareTex[i], 0);
+		status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+	}
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, defaultFramebuffer);
+	if(status != GL_FRAMEBUFFER_COMPLETE_EXT){
+		cleanupLensFlare();
+		return 0;
+	}
+
+	return 1;
+}
+
+
+void resizeLensFlare(int width, int height){
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &defaultFramebuffer);
+	defaultViewport[0] = 0;
+	defaultViewport[1] = 0;
+	defaultViewport[2] = width;
+	defaultViewport[3] = height;
+
+	glUseProgram(flareProgram);
+	glUniform1f(aspectUniform, float(width) / float(height));
+	glUseProgram(0);
+	flareWidth = (width + LENSFLARE_DOWNSAMPLE - 1) / LENSFLARE_DOWNSAMPLE;
+	flareHeight = (height + LENSFLARE_DOWNSAMPLE - 1) / LENSFLARE_DOWNSAMPLE;
+	for(int i=0; i<2; ++i){
+		glBindTexture(GL_TEXTURE_2D, flareTex[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, flareWidth, flareHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void beginLensFlare(unsigned int &stateChanges){
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, flareFramebuffer[0]);
+	++stateChanges;
+	glViewport(0, 0, flareWidth, flareHeight);
+	++stateChanges;
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
+
+void endLensFlare(float intensity, unsigned int &stateChanges){
+	// ghosts and halo
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, flareFramebuffer[1]);
+	++stateChanges;
+	glDisable(GL_BLEND);
+	++stateChanges;
+	glUseProgram(flareProgram);
+	++stateChanges;
+	glUniform2f(texelUniform, 1.0f / float(flareWidth), 1.0f / float(flareHeight));
+	glUniform1f(intensityUniform, intensity * LENSFLARE_GAIN);
+	glBindTexture(GL_TEXTURE_2D, flareTex[0]);
+	++stateChanges;
+	drawScreenQuad();
+	glUseProgram(0);
+	++stateChanges;
+
+	// added onto the frame
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, defaultFramebuffer);
+	++stateChanges;
+	glViewport(defaultViewport[0], defaultViewport[1], defaultViewport[2], defaultViewport[3]);
+	++stateChanges;
+	glEnable(GL_BLEND);
+	++stateChanges;
+	glBlendFunc(GL_ONE, GL_ONE);
+	++stateChanges;
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glBindTexture(GL_TEXTURE_2D, flareTex[1]);
+	++stateChanges;
+	drawScreenQuad();
+	glBindTexture(GL_TEXTURE_2D, 0);
+	++stateChanges;
+}
+
+
+void cleanupLensFlare(){
+	if(flareFramebuffer[0])
+		glDeleteFramebuffersEXT(2, flareFramebuffer);
+	if(flareTex[0])
+		glDeleteTextures(2, flareTex);
+	if(flareProgram)
+		glDeleteProgram(flareProgram);
+	flareFramebuffer[0] = flareFramebuffer[1] = 0;
+	flareTex[0] = flareTex[1] = 0;
+	flareProgram = 0;
+}
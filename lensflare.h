@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef LENSFLARE_H
+#define LENSFLARE_H
+
+
+
+// Lens flares as a post process (FLARESTYLE_SCREEN), after John Chapman's
+// "Pseudo Lens Flare".  The glow billboards, which hold everything that
+// shines, are drawn again into a small target.  A full screen pass over that
+// target then gathers ghosts of it reflected through the middle of the screen,
+// plus a halo, and the result is added onto the frame.  What this costs
+// depends on the size of the screen rather than on how many lights there are.
+
+// Make the targets and shader.  Returns 0 if OpenGL can't do it, in which case
+// lens flares should be drawn as sprites (flare()) instead.
+int initLensFlare(int width, int height);
+// The window, and the framebuffer drawn into, changed.  Also called by
+// initLensFlare().
+void resizeLensFlare(int width, int height);
+// Draw the glow billboards between these two, with the current blend function
+// and sprite atlas.  intensity scales the flares (dFlare * 0.01).  Both add
+// the blend functions, textures, shader programs, and render targets
+// (framebuffers and viewports) they set to stateChanges.
+void beginLensFlare(unsigned int &stateChanges);
+void endLensFlare(float intensity, unsigned int &stateChanges);
+void cleanupLensFlare();
+
+
+
+#endif  // LENSFLARE_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <string.h>
+#include "oit.h"
+#include "glshader.h"
+
+
+
+// Smoke is drawn with the fixed function's transform and color.  The weight
+// falls off with the fourth power of distance (McGuire and Bavoil's equation
+// 9, scaled for feet).  It is capped low enough that hundreds of nearby puffs
+// can't overflow the half float targets.
+static const char* smokeVertexShader =
+	"#version 120\n"
+	"varying float viewDepth;\n"
+	"void main(){\n"
+	"	vec4 eye = gl_ModelViewMatrix * gl_Vertex;\n"
+	"	viewDepth = -eye.z;\n"
+	"	gl_Position = gl_ProjectionMatrix * eye;\n"
+	"	gl_FrontColor = gl_Color;\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"}\n";
+static const char* smokeFragmentShader =
+	"#version 120\n"
+	"uniform sampler2D smokeTex;\n"
+	"varying float viewDepth;\n"
+	"void main(){\n"
+	"	vec4 color = gl_Color * texture2D(smokeTex, gl_TexCoord[0].st);\n"
+	"	float z = viewDepth * 0.001;\n"
+	"	float weight = color.a * clamp(0.03 / (1e-5 + z * z * z * z), 1e-2, 3e2);\n"
+	"	gl_FragData[0] = vec4(color.rgb * weight, color.a);\n"
+	"	gl_FragData[1] = vec4(weight);\n"
+	"}\n";
+// Average the weighted colors and lay them over the frame
+static const char* resolveFragmentShader =
+	"#version 120\n"
+	"uniform sampler2D accumTex;\n"
+	"uniform sampler2D weightTex;\n"
+	"void main(){\n"
+	"	vec4 accum = texture2D(accumTex, gl_TexCoord[0].st);\n"
+	"	float weight = texture2D(weightTex, gl_TexCoord[0].st).r;\n"
+	"	gl_FragColor = vec4(accum.rgb / max(weight, 1e-5), 1.0 - accum.a);\n"
+	"}\n";
+
+static GLuint oitFramebuffer = 0;
+static GLuint oitTex[2] = {0, 0};  // weighted colors and revealage, total weight
+static GLuint smokeProgram = 0;
+static GLuint resolveProgram = 0;
+static GLint defaultFramebuffer = 0;  // where the frame is drawn, recorded by initOit() and resizeOit()
+
+
+
+int initOit(int width, int height){
+	const char* extensions((const char*)glGetString(GL_EXTENSIONS));
+	if(!extensions || !strstr(extensions, "GL_EXT_framebuffer_object")
+		|| !strstr(extensions, "GL_ARB_texture_float"))
+		return 0;
+
+	smokeProgram = linkShaderProgram(smokeVertexShader, smokeFragmentShader);
+	resolveProgram = linkShaderProgram(NULL, resolveFragmentShader);
+	if(!smokeProgram || !resolveProgram){
+		cleanupOit();
+		return 0;
+	}
+	glUseProgram(smokeProgram);
+	glUniform1i(glGetUniformLocation(smokeProgram, "smokeTex"), 0);
+	glUseProgram(resolveProgram);
+	glUniform1i(glGetUniformLocation(resolveProgram, "accumTex"), 0);
+	glUniform1i(glGetUniformLocation(resolveProgram, "weightTex"), 1);
+	glUseProgram(0);
+
+	// Both targets are the same format because EXT_framebuffer_object
+	// doesn't promise that mixed formats work
+	glGenTextures(2, oitTex);
+	for(int i=0; i<2; ++i){
+		glBindTexture(GL_TEXTURE_2D, oitTex[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	resizeOit(width, height);
+
+	glGenFramebuffersEXT(1, &oitFramebuffer);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, oitFramebuffer);
+	glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, oitTex[0], 0);
+	glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT1_EXT, GL_TEXTURE_2D, oitTex[1], 0);
+	const GLenum buffers[2] = {GL_COLOR_ATTACHMENT0_EXT, GL_COLOR_ATTACHMENT1_EXT};
+	glDrawBuffers(2, buffers);
+	const GLenum status(glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT));
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, defaultFramebuffer);
+	if(status != GL_FRAMEBUFFER_COMPLETE_EXT){
+		cleanupOit();
+		return 0;
+	}
+
+	return 1;
+}
+
+
+void resizeOit(int width, int height){
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &defaultFramebuffer);
+	for(int i=0; i<2; ++i){
+		glBindTexture(GL_TEXTURE_2D, oitTex[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F_ARB, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void beginOit(unsigned int &stateChanges){
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, oitFramebuffer);
+	++stateChanges;
+	// weighted colors start at nothing and revealage at all (alpha is the
+	// clear color's 1.0)
+	glClear(GL_COLOR_BUFFER_BIT);
+	glUseProgram(smokeProgram);
+	++stateChanges;
+	// Colors and weights add up; alpha multiplies by 1 - alpha.  One blend
+	// function for both targets works on OpenGL 2.1.
+	glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+	++stateChanges;
+}
+
+
+void endOit(unsigned int &stateChanges){
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, defaultFramebuffer);
+	++stateChanges;
+	glUseProgram(resolveProgram);
+	++stateChanges;
+	glBindTexture(GL_TEXTURE_2D, oitTex[0]);
+	++stateChanges;
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, oitTex[1]);
+	++stateChanges;
+	glActiveTexture(GL_TEXTURE0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	++stateChanges;
+
+	// one quad over the whole screen
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glBegin(GL_TRIANGLE_STRIP);
+		glTexCoord2f(0.0f, 0.0f);
+		glVertex2f(-1.0f, -1.0f);
+		glTexCoord2f(1.0f, 0.0f);
+		glVertex2f(1.0f, -1.0f);
+		glTexCoord2f(0.0f, 1.0f);
+		glVertex2f(-1.0f, 1.0f);
+		glTexCoord2f(1.0f, 1.0f);
+		glVertex2f(1.0f, 1.0f);
+	glEnd();
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	++stateChanges;
+	glActiveTexture(GL_TEXTURE0);
+	glUseProgram(0);
+	++stateChanges;
+}
+
+
+void cleanupOit(){
+	if(oitFramebuffer)
+		glDeleteFramebuffersEXT(1, &oitFramebuffer);
+	if(oitTex[0])
+		glDeleteTextures(2, oitTex);
+	if(smokeProgram)
+		glDeleteProgram(smokeProgram);
+	if(resolveProgram)
+		glDeleteProgram(resolveProgram);
+	oitFramebuffer = 0;
+	oitTex[0] = oitTex[1] = 0;
+	smokeProgram = resolveProgram = 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef OIT_H
+#define OIT_H
+
+
+
+struct SkyrocketSaverSettings;
+
+
+// Weighted blended order-independent transparency for smoke (McGuire and
+// Bavoil, "Weighted Blended Order-Independent Transparency", 2013).  Smoke is
+// drawn in any order into two floating point targets, one adding up weighted
+// colors and one multiplying together how much of the background shows
+// through, and then composited over the frame in one full screen pass.
+// Nearer smoke gets more weight, so it mostly looks sorted without sorting.
+
+// Make the targets and shaders.  Returns 0 if OpenGL can't do it, in which
+// case smoke should be sorted instead.
+int initOit(int width, int height);
+// The window, and the framebuffer drawn into, changed.  Also called by initOit().
+void resizeOit(int width, int height);
+// Draw SMOKE billboards between these two, with drawBillboards()'s plain
+// vertex arrays so that the smoke shader is used.  Both add the blend
+// functions, textures, shader programs, and render targets they set to
+// stateChanges.
+void beginOit(unsigned int &stateChanges);
+void endOit(unsigned int &stateChanges);
+void cleanupOit();
+
+
+
+#endif  // OIT_H
@@ -25,23 +25,9 @@
 #include "world.h"
 
 
+// Explosions fetch random numbers for this many stars at once
+#define POPBATCH 64
 
-particle::particle(SkyrocketSaverSettings *inSettings){
-	type = STAR;
-	displayList = inSettings->flarelist[0];
-	drag = 0.612f;  // terminal velocity of 20 ft/s
-	t = 2.0f;
-	tr = t;
-	bright = 1.0f;
-	life = bright;
-	size = 30.0f;
-	makeSmoke = 0;
-
-	smokeTimeIndex = 0;
-	smokeTrailLength = 0.0f;
-	sparkTrailLength = 0.0f;
-	depth = 0.0f;
-}
 
 void particle::randomColor(rsVec& color){
 	int i, j, k;
@@ -74,6 +60,12 @@ void particle::randomColor(rsVec& color){
 	//return(color);
 }
 
+void particle::randomColor(particleVec color){
+	rsVec newcolor;
+	randomColor(newcolor);
+	color = newcolor;
+}
+
 void particle::initRocket(SkyrocketSaverSettings *inSettings){
 	// Thrust, initial velocity, and t (time) should send
 	// rockets to about 800 to 1200 feet before exploding.
@@ -109,17 +101,17 @@ void particle::initRocket(SkyrocketSaverSettings *inSettings){
 	sparkTrailLength = 0.0f;
 	explosiontype = 0;
 
-	if(soundengine){
+	if(inSettings->dSound){
 		if(rsRandi(2))
-			soundengine->insertSoundNode(LAUNCH1SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH1SOUND, xyz, inSettings);
 		else
-			soundengine->insertSoundNode(LAUNCH2SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH2SOUND, xyz, inSettings);
 	}
 }
 
 void particle::initFountain(SkyrocketSaverSettings *inSettings){
 	type = FOUNTAIN;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	size = 30.0f;
 	// position can be defined here because these are always on the ground
 	xyz[0] = rsRandf(300.0f) - 150.0f;
@@ -131,17 +123,17 @@ void particle::initFountain(SkyrocketSaverSettings *inSettings){
 	life = 1.0f;
 	makeSmoke = 0;
 
-	if(soundengine){
+	if(inSettings->dSound){
 		if(rsRandi(2))
-			soundengine->insertSoundNode(LAUNCH1SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH1SOUND, xyz, inSettings);
 		else
-			soundengine->insertSoundNode(LAUNCH2SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH2SOUND, xyz, inSettings);
 	}
 }
 
 void particle::initSpinner(SkyrocketSaverSettings *inSettings){
 	type = SPINNER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
 	randomColor(rgb);
 	spin = rsRandf(3.0f) + 12.0f;  // radial velocity
@@ -155,17 +147,17 @@ void particle::initSpinner(SkyrocketSaverSettings *inSettings){
 	makeSmoke = 1;
 	sparkTrailLength = 0.0f;
 
-	if(soundengine){
+	if(inSettings->dSound){
 		if(rsRandi(2))
-			soundengine->insertSoundNode(LAUNCH1SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH1SOUND, xyz, inSettings);
 		else
-			soundengine->insertSoundNode(LAUNCH2SOUND, xyz, inSettings->cameraPos);
+			queueSound(LAUNCH2SOUND, xyz, inSettings);
 	}
 }
 
 void particle::initSmoke(rsVec pos, rsVec speed, SkyrocketSaverSettings *inSettings){
 	type = SMOKE;
-	displayList = inSettings->smokelist[rsRandi(5)];
+	sprite = SPRITE_SMOKE + rsRandi(5);
 	xyz = pos;
 	vel = speed;
 	rgb[0] = rgb[1] = rgb[2] = 0.01f * float(inSettings->dAmbient);
@@ -177,12 +169,12 @@ void particle::initSmoke(rsVec pos, rsVec speed, SkyrocketSaverSettings *inSetti
 
 void particle::initStar(SkyrocketSaverSettings *inSettings){
 	type = STAR;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
 	size = 30.0f;
 	t = tr = rsRandf(1.0f) + 2.0f;
 	life = 1.0f;
-	static int someSmoke = 0;
+	int& someSmoke = currentSomeSmoke(inSettings);
 	makeSmoke = inSettings->whichSmoke[someSmoke];
 	smokeTrailLength = 0.0f;
 	++someSmoke;
@@ -192,7 +184,7 @@ void particle::initStar(SkyrocketSaverSettings *inSettings){
 
 void particle::initStreamer(SkyrocketSaverSettings *inSettings){
 	type = STREAMER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
 	size = 30.0f;
 	t = tr = rsRandf(1.0f) + 3.0f;
@@ -202,7 +194,7 @@ void particle::initStreamer(SkyrocketSaverSettings *inSettings){
 
 void particle::initMeteor(SkyrocketSaverSettings *inSettings){
 	type = METEOR;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
 	t = tr = rsRandf(1.0f) + 3.0f;
 	life = 1.0f;
@@ -212,7 +204,7 @@ void particle::initMeteor(SkyrocketSaverSettings *inSettings){
 
 void particle::initStarPopper(SkyrocketSaverSettings *inSettings){
 	type = POPPER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.4f;
 	t = tr = rsRandf(1.5f) + 3.0f;
 	life = 1.0f;
@@ -224,7 +216,7 @@ void particle::initStarPopper(SkyrocketSaverSettings *inSettings){
 
 void particle::initStreamerPopper(SkyrocketSaverSettings *inSettings){
 	type = POPPER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	size = 0.0f;
 	drag = 0.4f;
 	t = tr = rsRandf(1.5f) + 3.0f;
@@ -236,7 +228,7 @@ void particle::initStreamerPopper(SkyrocketSaverSettings *inSettings){
 
 void particle::initMeteorPopper(SkyrocketSaverSettings *inSettings){
 	type = POPPER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	size = 0.0f;
 	drag = 0.4f;
 	t = tr = rsRandf(1.5f) + 3.0f;
@@ -248,7 +240,7 @@ void particle::initMeteorPopper(SkyrocketSaverSettings *inSettings){
 
 void particle::initLittlePopper(SkyrocketSaverSettings *inSettings){
 	type = POPPER;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.4f;
 	t = tr = 4.0f * (0.5f - sinf(rsRandf(PI))) + 4.5f;
 	life = 1.0f;
@@ -259,7 +251,7 @@ void particle::initLittlePopper(SkyrocketSaverSettings *inSettings){
 
 void particle::initBee(SkyrocketSaverSettings *inSettings){
 	type = BEE;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	size = 10.0f;
 	drag = 0.5f;
 	t = tr = rsRandf(2.5f) + 2.5f;
@@ -276,13 +268,12 @@ void particle::initBee(SkyrocketSaverSettings *inSettings){
 
 void particle::initSucker(SkyrocketSaverSettings *inSettings){
 	int i;
-	particle* newp;
 	rsVec color;
 	float temp1, temp2, ch, sh, cp, sp;
 
 	type = SUCKER;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
-	displayList = inSettings->flarelist[2];
+	sprite = SPRITE_FLARE + 2;
 	rgb.set(1.0f, 1.0f, 1.0f);
 	size = 300.0f;
 	t = tr = 4.0f;
@@ -290,13 +281,13 @@ void particle::initSucker(SkyrocketSaverSettings *inSettings){
 	makeSmoke = 0;
 
 	// make explosion
-	newp = addParticle(inSettings);
-	newp->type = EXPLOSION;
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->rgb.set(1.0f, 1.0f, 1.0f);
-	newp->size = 200.0f;
-	newp->t = newp->tr = 4.0f;
+	particle newp(addParticle(inSettings));
+	newp.type = EXPLOSION;
+	newp.xyz = xyz;
+	newp.vel = vel;
+	newp.rgb.set(1.0f, 1.0f, 1.0f);
+	newp.size = 200.0f;
+	newp.t = newp.tr = 4.0f;
 
 	// Make double ring to go along with sucker
 	randomColor(color);
@@ -307,30 +298,30 @@ void particle::initSucker(SkyrocketSaverSettings *inSettings){
 	cp = cosf(temp2);
 	sp = sinf(temp2);
 	for(i=0; i<90; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
 		// pitch
-		newp->vel[1] = sp * newp->vel[2];
-		newp->vel[2] = cp * newp->vel[2];
+		newp.vel[1] = sp * newp.vel[2];
+		newp.vel[2] = cp * newp.vel[2];
 		// heading
-		temp1 = newp->vel[0];
-		newp->vel[0] = ch * temp1 + sh * newp->vel[1];
-		newp->vel[1] = -sh * temp1 + ch * newp->vel[1];
+		temp1 = newp.vel[0];
+		newp.vel[0] = ch * temp1 + sh * newp.vel[1];
+		newp.vel[1] = -sh * temp1 + ch * newp.vel[1];
 		// multiply velocity
-		newp->vel[0] *= 350.0f + rsRandf(30.0f);
-		newp->vel[1] *= 350.0f + rsRandf(30.0f);
-		newp->vel[2] *= 350.0f + rsRandf(30.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		newp.vel[0] *= 350.0f + rsRandf(30.0f);
+		newp.vel[1] *= 350.0f + rsRandf(30.0f);
+		newp.vel[2] *= 350.0f + rsRandf(30.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 	randomColor(color);
 	temp1 = rsRandf(PI);  // heading
@@ -340,39 +331,38 @@ void particle::initSucker(SkyrocketSaverSettings *inSettings){
 	cp = cosf(temp2);
 	sp = sinf(temp2);
 	for(i=0; i<90; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
 		// pitch
-		newp->vel[1] = sp * newp->vel[2];
-		newp->vel[2] = cp * newp->vel[2];
+		newp.vel[1] = sp * newp.vel[2];
+		newp.vel[2] = cp * newp.vel[2];
 		// heading
-		temp1 = newp->vel[0];
-		newp->vel[0] = ch * temp1 + sh * newp->vel[1];
-		newp->vel[1] = -sh * temp1 + ch * newp->vel[1];
+		temp1 = newp.vel[0];
+		newp.vel[0] = ch * temp1 + sh * newp.vel[1];
+		newp.vel[1] = -sh * temp1 + ch * newp.vel[1];
 		// multiply velocity
-		newp->vel[0] *= 600.0f + rsRandf(50.0f);
-		newp->vel[1] *= 600.0f + rsRandf(50.0f);
-		newp->vel[2] *= 600.0f + rsRandf(50.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		newp.vel[0] *= 600.0f + rsRandf(50.0f);
+		newp.vel[1] *= 600.0f + rsRandf(50.0f);
+		newp.vel[2] *= 600.0f + rsRandf(50.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 
-	if(soundengine)
-		soundengine->insertSoundNode(SUCKSOUND, xyz, inSettings->cameraPos);
+	if(inSettings->dSound)
+		queueSound(SUCKSOUND, xyz, inSettings);
 }
 
 void particle::initShockwave(SkyrocketSaverSettings *inSettings){
 	int i;
-	particle* newp;
 	rsVec color;
 
 	type = SHOCKWAVE;
@@ -384,66 +374,65 @@ void particle::initShockwave(SkyrocketSaverSettings *inSettings){
 	bright = life;
 
 	// make explosion
-	newp = addParticle(inSettings);
-	newp->type = EXPLOSION;
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->rgb.set(1.0f, 1.0f, 1.0f);
-	newp->size = 300.0f;
-	newp->t = newp->tr = 2.0f;
+	particle newp(addParticle(inSettings));
+	newp.type = EXPLOSION;
+	newp.xyz = xyz;
+	newp.vel = vel;
+	newp.rgb.set(1.0f, 1.0f, 1.0f);
+	newp.size = 300.0f;
+	newp.t = newp.tr = 2.0f;
 	life = 1.0f;
 	makeSmoke = 0;
 
 	// Little sphere without smoke
 	randomColor(color);
 	for(i=0; i<75; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel *= (rsRandf(10.0f) + 100.0f);
-		newp->vel += vel;
-		newp->rgb = color;
-		newp->size = 100.0f;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = rsRandf(1.0f) - 0.5f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
+		newp.vel *= (rsRandf(10.0f) + 100.0f);
+		newp.vel += vel;
+		newp.rgb = color;
+		newp.size = 100.0f;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 
 	// Disk of stars without smoke
 	randomColor(color);
 	for(i=0; i<150; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->drag = 0.2f;
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(0.03f) - 0.005f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.drag = 0.2f;
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = rsRandf(0.03f) - 0.005f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
 		// multiply velocity
-		newp->vel *= (rsRandf(30.0f) + 500.0f);
-		newp->vel += vel;
-		newp->rgb = color;
-		newp->size = 50.0f;
-		newp->t = newp->tr = rsRandf(2.0f) + 3.0f;
-		newp->makeSmoke = 0;
+		newp.vel *= (rsRandf(30.0f) + 500.0f);
+		newp.vel += vel;
+		newp.rgb = color;
+		newp.size = 50.0f;
+		newp.t = newp.tr = rsRandf(2.0f) + 3.0f;
+		newp.makeSmoke = 0;
 	}
 
-	if(soundengine)
-		soundengine->insertSoundNode(NUKESOUND, xyz, inSettings->cameraPos);
+	if(inSettings->dSound)
+		queueSound(NUKESOUND, xyz, inSettings);
 }
 
 void particle::initStretcher(SkyrocketSaverSettings *inSettings){
 	int i;
-	particle* newp;
 	rsVec color;
 
 	type = STRETCHER;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
-	displayList = inSettings->flarelist[3];
+	sprite = SPRITE_FLARE + 3;
 	rgb.set(1.0f, 1.0f, 1.0f);
 	size = 0.0f;
 	t = tr = 4.0f;
@@ -451,89 +440,88 @@ void particle::initStretcher(SkyrocketSaverSettings *inSettings){
 	makeSmoke = 0;
 
 	// explosion
-	newp = addParticle(inSettings);
-	newp->type = EXPLOSION;
-	newp->displayList = inSettings->flarelist[0];
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->rgb.set(1.0f, 0.8f, 0.6f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 4.0f;
+	particle newp(addParticle(inSettings));
+	newp.type = EXPLOSION;
+	newp.sprite = SPRITE_FLARE;
+	newp.xyz = xyz;
+	newp.vel = vel;
+	newp.rgb.set(1.0f, 0.8f, 0.6f);
+	newp.size = 400.0f;
+	newp.t = newp.tr = 4.0f;
 	life = 1.0f;
-	newp->makeSmoke = 0;
+	newp.makeSmoke = 0;
 
 	// Make triple ring to go along with stretcher
 	randomColor(color);
 	for(i=0; i<80; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel[0] *= 400.0f + rsRandf(30.0f);
-		newp->vel[1] += rsRandf(70.0f) - 35.0f;
-		newp->vel[2] *= 400.0f + rsRandf(30.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
+		newp.vel[0] *= 400.0f + rsRandf(30.0f);
+		newp.vel[1] += rsRandf(70.0f) - 35.0f;
+		newp.vel[2] *= 400.0f + rsRandf(30.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 	randomColor(color);
 	for(i=0; i<80; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel[0] *= 550.0f + rsRandf(40.0f);
-		newp->vel[1] += rsRandf(70.0f) - 35.0f;
-		newp->vel[2] *= 550.0f + rsRandf(40.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
+		newp.vel[0] *= 550.0f + rsRandf(40.0f);
+		newp.vel[1] += rsRandf(70.0f) - 35.0f;
+		newp.vel[2] *= 550.0f + rsRandf(40.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 	randomColor(color);
 	for(i=0; i<80; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel[0] *= 700.0f + rsRandf(50.0f);
-		newp->vel[1] += rsRandf(70.0f) - 35.0f;
-		newp->vel[2] *= 700.0f + rsRandf(50.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
+		newp.vel[0] *= 700.0f + rsRandf(50.0f);
+		newp.vel[1] += rsRandf(70.0f) - 35.0f;
+		newp.vel[2] *= 700.0f + rsRandf(50.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 
-	if(soundengine)
-		soundengine->insertSoundNode(SUCKSOUND, xyz, inSettings->cameraPos);
+	if(inSettings->dSound)
+		queueSound(SUCKSOUND, xyz, inSettings);
 }
 
 void particle::initBigmama(SkyrocketSaverSettings *inSettings){
 	int i;
-	particle* newp;
 	rsVec color;
 	float temp;
 
 	type = BIGMAMA;
 	drag = 0.612f;  // terminal velocity of 20 ft/s
-	displayList = inSettings->flarelist[2];
+	sprite = SPRITE_FLARE + 2;
 	rgb.set(0.6f, 0.6f, 1.0f);
 	size = 0.0f;
 	t = tr = 5.0f;
@@ -542,151 +530,169 @@ void particle::initBigmama(SkyrocketSaverSettings *inSettings){
 	makeSmoke = 0;
 
 	// explosion
-	newp = addParticle(inSettings);
-	newp->type = EXPLOSION;
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->rgb.set(0.8f, 0.8f, 1.0f);
-	newp->size = 200.0f;
-	newp->t = newp->tr = 2.5f;
-	life = 1.0f;
-	newp->makeSmoke = 0;
+	{
+		particle newp(addParticle(inSettings));
+		newp.type = EXPLOSION;
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.rgb.set(0.8f, 0.8f, 1.0f);
+		newp.size = 200.0f;
+		newp.t = newp.tr = 2.5f;
+		life = 1.0f;
+		newp.makeSmoke = 0;
+	}
 
 	// vertical stars
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] += 15.0f;
-	newp->rgb.set(1.0f, 1.0f, 0.9f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 3.0f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] -= 15.0f;
-	newp->rgb.set(1.0f, 1.0f, 0.9f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 3.0f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] += 45.0f;
-	newp->rgb.set(1.0f, 1.0f, 0.6f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 3.5f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] -= 45.0f;
-	newp->rgb.set(1.0f, 1.0f, 0.6f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 3.5f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] += 75.0f;
-	newp->rgb.set(1.0f, 0.5f, 0.3f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 4.0f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] -= 75.0f;
-	newp->rgb.set(1.0f, 0.5f, 0.3f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 4.0f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] += 105.0f;
-	newp->rgb.set(1.0f, 0.0f, 0.0f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 4.5f;
-	newp->makeSmoke = 0;
-	newp = addParticle(inSettings);
-	newp->initStar(inSettings);
-	newp->xyz = xyz;
-	newp->vel = vel;
-	newp->drag = 0.0f;
-	newp->vel[1] -= 105.0f;
-	newp->rgb.set(1.0f, 0.0f, 0.0f);
-	newp->size = 400.0f;
-	newp->t = newp->tr = 4.5f;
-	newp->makeSmoke = 0;
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] += 15.0f;
+		newp.rgb.set(1.0f, 1.0f, 0.9f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 3.0f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] -= 15.0f;
+		newp.rgb.set(1.0f, 1.0f, 0.9f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 3.0f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] += 45.0f;
+		newp.rgb.set(1.0f, 1.0f, 0.6f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 3.5f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] -= 45.0f;
+		newp.rgb.set(1.0f, 1.0f, 0.6f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 3.5f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] += 75.0f;
+		newp.rgb.set(1.0f, 0.5f, 0.3f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 4.0f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] -= 75.0f;
+		newp.rgb.set(1.0f, 0.5f, 0.3f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 4.0f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] += 105.0f;
+		newp.rgb.set(1.0f, 0.0f, 0.0f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 4.5f;
+		newp.makeSmoke = 0;
+	}
+	{
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel = vel;
+		newp.drag = 0.0f;
+		newp.vel[1] -= 105.0f;
+		newp.rgb.set(1.0f, 0.0f, 0.0f);
+		newp.size = 400.0f;
+		newp.t = newp.tr = 4.5f;
+		newp.makeSmoke = 0;
+	}
 
 	// Sphere without smoke
 	randomColor(color);
 	for(i=0; i<75; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = rsRandf(1.0f) - 0.5f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
 		temp = 600.0f + rsRandf(100.0f);
-		newp->vel[0] *= temp;
-		newp->vel[1] *= temp;
-		newp->vel[2] *= temp;
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->t = newp->tr = rsRandf(2.0f) + 2.0f;
-		newp->makeSmoke = 0;
+		newp.vel[0] *= temp;
+		newp.vel[1] *= temp;
+		newp.vel[2] *= temp;
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.t = newp.tr = rsRandf(2.0f) + 2.0f;
+		newp.makeSmoke = 0;
 	}
 
 	// disk of big streamers
 	randomColor(color);
 	for(i=0; i<50; i++){
-		newp = addParticle(inSettings);
-		newp->initStreamer(inSettings);
-		newp->drag = 0.3f;
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel[0] *= 1000.0f + rsRandf(100.0f);
-		newp->vel[1] += rsRandf(100.0f) - 50.0f;
-		newp->vel[2] *= 1000.0f + rsRandf(100.0f);
-		newp->vel[0] += vel[0];
-		newp->vel[1] += vel[1];
-		newp->vel[2] += vel[2];
-		newp->rgb = color;
-		newp->size = 100.0f;
-		newp->t = newp->tr = rsRandf(6.0f) + 3.0f;
-		newp->makeSmoke = 0;
+		particle newp(addParticle(inSettings));
+		newp.initStreamer(inSettings);
+		newp.drag = 0.3f;
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
+		newp.vel[0] *= 1000.0f + rsRandf(100.0f);
+		newp.vel[1] += rsRandf(100.0f) - 50.0f;
+		newp.vel[2] *= 1000.0f + rsRandf(100.0f);
+		newp.vel[0] += vel[0];
+		newp.vel[1] += vel[1];
+		newp.vel[2] += vel[2];
+		newp.rgb = color;
+		newp.size = 100.0f;
+		newp.t = newp.tr = rsRandf(6.0f) + 3.0f;
+		newp.makeSmoke = 0;
 	}
 
-	if(soundengine)
-		soundengine->insertSoundNode(NUKESOUND, xyz, inSettings->cameraPos);
+	if(inSettings->dSound)
+		queueSound(NUKESOUND, xyz, inSettings);
 }
 
 void particle::initExplosion(SkyrocketSaverSettings *inSettings){
 	type = EXPLOSION;
-	displayList = inSettings->flarelist[0];
+	sprite = SPRITE_FLARE;
 	drag = 0.612f;
 	t = tr = 0.5f;
 	bright = 1.0f;
@@ -812,42 +818,43 @@ void particle::initExplosion(SkyrocketSaverSettings *inSettings){
 		popMeteors(10, 100.0f, rgb, inSettings);
 	}
 
-	if(soundengine){
+	if(inSettings->dSound){
 		if(explosiontype == 17)  // extra resounding boom
-			soundengine->insertSoundNode(BOOM4SOUND, xyz, inSettings->cameraPos);
+			queueSound(BOOM4SOUND, xyz, inSettings);
 		// make bees and big booms whistle sometimes
 		if(explosiontype == 16 || explosiontype == 17)
 			if(rsRandi(2))
-				soundengine->insertSoundNode(WHISTLESOUND, xyz, inSettings->cameraPos);
+				queueSound(WHISTLESOUND, xyz, inSettings);
 		// regular booms
 		if(explosiontype <= 16 || explosiontype >= 100)
-			soundengine->insertSoundNode(BOOM1SOUND + rsRandi(3), xyz, inSettings->cameraPos);
+			queueSound(BOOM1SOUND + rsRandi(3), xyz, inSettings);
 	// sucker and stretcher take care of their own sounds
 	}
 }
 
 void particle::popSphere(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
+	float rnd[POPBATCH * 4];
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel *= v0 + rsRandf(50.0f);
-		newp->vel += vel;
-		newp->rgb = color;
+		// random directions and speeds for POPBATCH stars at a time
+		const int r((i % POPBATCH) * 4);
+		if(!r)
+			rsCurrentRandom->fillf(rnd, 4 * (numParts - i < POPBATCH ? numParts - i : POPBATCH), 1.0f);
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel.set(rnd[r] - 0.5f, rnd[r + 1] - 0.5f, rnd[r + 2] - 0.5f);
+		newp.vel.normalize();
+		newp.vel *= v0 + rnd[r + 3] * 50.0f;
+		newp.vel += vel;
+		newp.rgb = color;
+		// the occasional long-lived star
+		if(i == numParts - 1 && !rsRandi(100))
+			newp.t = newp.tr = rsRandf(20.0f) + 5.0f;
 	}
-
-	if(!rsRandi(100))
-		newp->t = newp->tr = rsRandf(20.0f) + 5.0f;
 }
 
 void particle::popSplitSphere(int numParts, float v0, rsVec color1, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	rsVec color2;
 	rsVec planeNormal;
 
@@ -856,56 +863,60 @@ void particle::popSplitSphere(int numParts, float v0, rsVec color1, SkyrocketSav
 	planeNormal[1] = rsRandf(1.0f) - 0.5f;
 	planeNormal[2] = rsRandf(1.0f) - 0.5f;
 	planeNormal.normalize();
+	float rnd[POPBATCH * 4];
 	for(int i=0; i<numParts; i++){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		if(planeNormal.dot(newp->vel) > 0.0f)
-			newp->rgb = color1;
+		// random directions and speeds for POPBATCH stars at a time
+		const int r((i % POPBATCH) * 4);
+		if(!r)
+			rsCurrentRandom->fillf(rnd, 4 * (numParts - i < POPBATCH ? numParts - i : POPBATCH), 1.0f);
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel.set(rnd[r] - 0.5f, rnd[r + 1] - 0.5f, rnd[r + 2] - 0.5f);
+		newp.vel.normalize();
+		if(planeNormal.dot(newp.vel) > 0.0f)
+			newp.rgb = color1;
 		else
-			newp->rgb = color2;
-		newp->vel *= v0 + rsRandf(50.0f);
-		newp->vel += vel;
+			newp.rgb = color2;
+		newp.vel *= v0 + rnd[r + 3] * 50.0f;
+		newp.vel += vel;
+		// the occasional long-lived star
+		if(i == numParts - 1 && !rsRandi(100))
+			newp.t = newp.tr = rsRandf(20.0f) + 5.0f;
 	}
-
-	if(!rsRandi(100))
-		newp->t = newp->tr = rsRandf(20.0f) + 5.0f;
 }
 
 void particle::popMultiColorSphere(int numParts, float v0, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	rsVec color[3];
 
 	randomColor(color[0]);
 	randomColor(color[1]);
 	randomColor(color[2]);
 	int j(0);
+	float rnd[POPBATCH * 4];
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel *= v0 + rsRandf(30.0f);
-		newp->vel += vel;
-		newp->rgb = color[j];
+		// random directions and speeds for POPBATCH stars at a time
+		const int r((i % POPBATCH) * 4);
+		if(!r)
+			rsCurrentRandom->fillf(rnd, 4 * (numParts - i < POPBATCH ? numParts - i : POPBATCH), 1.0f);
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel.set(rnd[r] - 0.5f, rnd[r + 1] - 0.5f, rnd[r + 2] - 0.5f);
+		newp.vel.normalize();
+		newp.vel *= v0 + rnd[r + 3] * 30.0f;
+		newp.vel += vel;
+		newp.rgb = color[j];
 		++j;
 		if(j >= 3)
 			j = 0;
+		// the occasional long-lived star
+		if(i == numParts - 1 && !rsRandi(100))
+			newp.t = newp.tr = rsRandf(20.0f) + 5.0f;
 	}
-
-	if(!rsRandi(100))
-		newp->t = newp->tr = rsRandf(20.0f) + 5.0f;
 }
 
 void particle::popRing(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 
 	float temph = rsRandf(PI);  // heading
 	float tempp = rsRandf(PI);  // pitch
@@ -914,141 +925,140 @@ void particle::popRing(int numParts, float v0, rsVec color, SkyrocketSaverSettin
 	const float cp(cosf(tempp));
 	const float sp(sinf(tempp));
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStar(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = 0.0f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
+		particle newp(addParticle(inSettings));
+		newp.initStar(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = 0.0f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel.normalize();
 		// pitch
-		newp->vel[1] = sp * newp->vel[2];
-		newp->vel[2] = cp * newp->vel[2];
+		newp.vel[1] = sp * newp.vel[2];
+		newp.vel[2] = cp * newp.vel[2];
 		// heading
-		const float temp(newp->vel[0]);
-		newp->vel[0] = ch * temp + sh * newp->vel[1];
-		newp->vel[1] = -sh * temp + ch * newp->vel[1];
+		const float temp(newp.vel[0]);
+		newp.vel[0] = ch * temp + sh * newp.vel[1];
+		newp.vel[1] = -sh * temp + ch * newp.vel[1];
 		// multiply velocity
-		newp->vel[0] *= v0 + rsRandf(50.0f);
-		newp->vel[1] *= v0 + rsRandf(50.0f);
-		newp->vel[2] *= v0 + rsRandf(50.0f);
-		newp->vel += vel;
-		newp->rgb = color;
+		newp.vel[0] *= v0 + rsRandf(50.0f);
+		newp.vel[1] *= v0 + rsRandf(50.0f);
+		newp.vel[2] *= v0 + rsRandf(50.0f);
+		newp.vel += vel;
+		newp.rgb = color;
+		// the occasional long-lived star
+		if(i == numParts - 1 && !rsRandi(100))
+			newp.t = newp.tr = rsRandf(20.0f) + 5.0f;
 	}
-
-	if(!rsRandi(100))
-		newp->t = newp->tr = rsRandf(20.0f) + 5.0f;
 }
 
 void particle::popStreamers(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
+	float rnd[POPBATCH * 4];
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStreamer(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel *= v0 + rsRandf(50.0f);
-		newp->vel += vel;
-		newp->rgb = color;
+		// random directions and speeds for POPBATCH stars at a time
+		const int r((i % POPBATCH) * 4);
+		if(!r)
+			rsCurrentRandom->fillf(rnd, 4 * (numParts - i < POPBATCH ? numParts - i : POPBATCH), 1.0f);
+		particle newp(addParticle(inSettings));
+		newp.initStreamer(inSettings);
+		newp.xyz = xyz;
+		newp.vel.set(rnd[r] - 0.5f, rnd[r + 1] - 0.5f, rnd[r + 2] - 0.5f);
+		newp.vel.normalize();
+		newp.vel *= v0 + rnd[r + 3] * 50.0f;
+		newp.vel += vel;
+		newp.rgb = color;
 	}
 }
 
 void particle::popMeteors(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
+	float rnd[POPBATCH * 4];
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initMeteor(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel.normalize();
-		newp->vel *= v0 + rsRandf(50.0f);
-		newp->vel += vel;
-		newp->rgb = color;
+		// random directions and speeds for POPBATCH stars at a time
+		const int r((i % POPBATCH) * 4);
+		if(!r)
+			rsCurrentRandom->fillf(rnd, 4 * (numParts - i < POPBATCH ? numParts - i : POPBATCH), 1.0f);
+		particle newp(addParticle(inSettings));
+		newp.initMeteor(inSettings);
+		newp.xyz = xyz;
+		newp.vel.set(rnd[r] - 0.5f, rnd[r + 1] - 0.5f, rnd[r + 2] - 0.5f);
+		newp.vel.normalize();
+		newp.vel *= v0 + rnd[r + 3] * 50.0f;
+		newp.vel += vel;
+		newp.rgb = color;
 	}
 }
 
 void particle::popStarPoppers(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	const float v0x2(v0 * 2.0f);
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStarPopper(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = vel[0] + rsRandf(v0x2) - v0;
-		newp->vel[1] = vel[1] + rsRandf(v0x2) - v0;
-		newp->vel[2] = vel[2] + rsRandf(v0x2) - v0;
-		newp->rgb = color;
+		particle newp(addParticle(inSettings));
+		newp.initStarPopper(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = vel[0] + rsRandf(v0x2) - v0;
+		newp.vel[1] = vel[1] + rsRandf(v0x2) - v0;
+		newp.vel[2] = vel[2] + rsRandf(v0x2) - v0;
+		newp.rgb = color;
 	}
 }
 
 void particle::popStreamerPoppers(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	const float v0x2(v0 * 2.0f);
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initStreamerPopper(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = vel[0] + rsRandf(v0x2) - v0;
-		newp->vel[1] = vel[1] + rsRandf(v0x2) - v0;
-		newp->vel[2] = vel[2] + rsRandf(v0x2) - v0;
-		newp->rgb = color;
+		particle newp(addParticle(inSettings));
+		newp.initStreamerPopper(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = vel[0] + rsRandf(v0x2) - v0;
+		newp.vel[1] = vel[1] + rsRandf(v0x2) - v0;
+		newp.vel[2] = vel[2] + rsRandf(v0x2) - v0;
+		newp.rgb = color;
 	}
 }
 
 void particle::popMeteorPoppers(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	const float v0x2(v0 * 2.0f);
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initMeteorPopper(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = vel[0] + rsRandf(v0x2) - v0;
-		newp->vel[1] = vel[1] + rsRandf(v0x2) - v0;
-		newp->vel[2] = vel[2] + rsRandf(v0x2) - v0;
-		newp->rgb = color;
+		particle newp(addParticle(inSettings));
+		newp.initMeteorPopper(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = vel[0] + rsRandf(v0x2) - v0;
+		newp.vel[1] = vel[1] + rsRandf(v0x2) - v0;
+		newp.vel[2] = vel[2] + rsRandf(v0x2) - v0;
+		newp.rgb = color;
 	}
 }
 
 void particle::popLittlePoppers(int numParts, float v0, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 	const float v0x2(v0 * 2.0f);
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initLittlePopper(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = vel[0] + rsRandf(v0x2) - v0;
-		newp->vel[1] = vel[1] + rsRandf(v0x2) - v0;
-		newp->vel[2] = vel[2] + rsRandf(v0x2) - v0;
+		particle newp(addParticle(inSettings));
+		newp.initLittlePopper(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = vel[0] + rsRandf(v0x2) - v0;
+		newp.vel[1] = vel[1] + rsRandf(v0x2) - v0;
+		newp.vel[2] = vel[2] + rsRandf(v0x2) - v0;
 	}
 
-	if(soundengine)
-		soundengine->insertSoundNode(POPPERSOUND, xyz, inSettings->cameraPos);
+	if(inSettings->dSound)
+		queueSound(POPPERSOUND, xyz, inSettings);
 }
 
 void particle::popBees(int numParts, float v0, rsVec color, SkyrocketSaverSettings *inSettings){
-	particle* newp;
 
 	for(int i=0; i<numParts; ++i){
-		newp = addParticle(inSettings);
-		newp->initBee(inSettings);
-		newp->xyz = xyz;
-		newp->vel[0] = rsRandf(1.0f) - 0.5f;
-		newp->vel[1] = rsRandf(1.0f) - 0.5f;
-		newp->vel[2] = rsRandf(1.0f) - 0.5f;
-		newp->vel *= v0;
-		newp->vel += vel;
-		newp->rgb = color;
+		particle newp(addParticle(inSettings));
+		newp.initBee(inSettings);
+		newp.xyz = xyz;
+		newp.vel[0] = rsRandf(1.0f) - 0.5f;
+		newp.vel[1] = rsRandf(1.0f) - 0.5f;
+		newp.vel[2] = rsRandf(1.0f) - 0.5f;
+		newp.vel *= v0;
+		newp.vel += vel;
+		newp.rgb = color;
 	}
 }
 
@@ -1068,14 +1078,10 @@ void particle::findDepth(SkyrocketSaverSettings *inSettings){
 //******************************************
 //  Update particles
 //******************************************
-void particle::update(SkyrocketSaverSettings *inSettings){
-	int i;
-	float temp;
+void particle::accelerate(SkyrocketSaverSettings *inSettings){
 	rsVec dir, crossvec;
 	rsQuat spinquat;
 	rsMatrix spinmat;
-	particle *newp;
-	rsVec rocketEjection;
 
 	// update velocities
 	if(type == ROCKET && life > endthrust){
@@ -1095,22 +1101,19 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		vel[1] += 500.0f * (cosf(tiltvec[1]) - 0.2f) * inSettings->frameTime;
 		vel[2] += 500.0f * cosf(tiltvec[2]) * inSettings->frameTime;
 	}
-	if(type != SMOKE)
-		vel[1] -= inSettings->frameTime * 32.0f;  // gravity
-	// apply air resistance
-	temp = 1.0f / (1.0f + drag * inSettings->frameTime);
-	vel *= temp * temp;
-
-	// update position
-	// (Fountains don't move)
-	if(type != FOUNTAIN){
-		lastxyz = xyz;
-		xyz += vel * inSettings->frameTime;
-		// Wind:  1/10 wind on ground; -1/2 wind at 500 feet; full wind at 2000 feet;
-		// This value is calculated to coincide with movement of the clouds in world.h
-		// Here's the polynomial wind equation that simulates windshear:
-		xyz[0] += (0.1f - 0.00175f * xyz[1] + 0.0000011f * xyz[1] * xyz[1]) * inSettings->dWind * inSettings->frameTime;
-	}
+}
+
+
+void particle::update(SkyrocketSaverSettings *inSettings){
+	int i;
+	float temp;
+	rsVec dir, crossvec;
+	rsQuat spinquat;
+	rsMatrix spinmat;
+	rsVec rocketEjection;
+
+	// Gravity, air resistance, and movement have already been applied
+	// to every particle by integrateParticles() (see kinematics.h).
 
 	// brightness and life
 	tr -= inSettings->frameTime;
@@ -1192,7 +1195,7 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 	}
 
 	// Produce smoke from rockets and other particles
-	static rsVec velvec;
+	rsVec velvec;
 	if(makeSmoke && inSettings->dSmoke){
 		rsVec diff = xyz - lastxyz;
 		// distance rocket traveled since last frame
@@ -1209,12 +1212,12 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 			rocketEjection *= -2.0f * thrust * (life - endthrust);
 			for(i=0; i<puffs; ++i){  // make puffs of smoke
 				smkpos += diff * multiplier;
-				newp = addParticle(inSettings);
+				particle newp(addParticle(inSettings));
 				velvec[0] = rocketEjection[0] + rsRandf(20.0f) - 10.0f;
 				velvec[1] = rocketEjection[1] + rsRandf(20.0f) - 10.0f;
 				velvec[2] = rocketEjection[2] + rsRandf(20.0f) - 10.0f;
-				newp->initSmoke(smkpos, velvec, inSettings);
-				newp->t = newp->tr = inSettings->smokeTime[smokeTimeIndex];
+				newp.initSmoke(smkpos, velvec, inSettings);
+				newp.t = newp.tr = inSettings->smokeTime[smokeTimeIndex];
 				++smokeTimeIndex;
 				if(smokeTimeIndex >= SMOKETIMES)
 					smokeTimeIndex = 0;
@@ -1223,12 +1226,12 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		else{  // just form smoke in place
 			for(i=0; i<puffs; ++i){
 				smkpos += diff * multiplier;
-				newp = addParticle(inSettings);
+				particle newp(addParticle(inSettings));
 				velvec[0] = rsRandf(20.0f) - 10.0f;
 				velvec[1] = rsRandf(20.0f) - 10.0f;
 				velvec[2] = rsRandf(20.0f) - 10.0f;
-				newp->initSmoke(smkpos, velvec, inSettings);
-				newp->t = newp->tr = inSettings->smokeTime[smokeTimeIndex];
+				newp.initSmoke(smkpos, velvec, inSettings);
+				newp.t = newp.tr = inSettings->smokeTime[smokeTimeIndex];
 				++smokeTimeIndex;
 				if(smokeTimeIndex >= SMOKETIMES)
 					smokeTimeIndex = 0;
@@ -1249,18 +1252,18 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		rocketEjection.normalize();
 		rocketEjection *= -thrust * (life - endthrust);
 		for(i=0; i<sparks; ++i){  // make sparks
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->xyz = xyz - (diff * rsRandf(1.0f));
-			newp->vel[0] = rocketEjection[0] + rsRandf(60.0f) - 30.0f;
-			newp->vel[1] = rocketEjection[1] + rsRandf(60.0f) - 30.0f;
-			newp->vel[2] = rocketEjection[2] + rsRandf(60.0f) - 30.0f;
-			newp->rgb = rgb;
-			newp->t = rsRandf(0.2f) + 0.1f;
-			newp->tr = newp->t;
-			newp->size = 8.0f * life;
-			newp->displayList = inSettings->flarelist[3];
-			newp->makeSmoke = 0;
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.xyz = xyz - (diff * rsRandf(1.0f));
+			newp.vel[0] = rocketEjection[0] + rsRandf(60.0f) - 30.0f;
+			newp.vel[1] = rocketEjection[1] + rsRandf(60.0f) - 30.0f;
+			newp.vel[2] = rocketEjection[2] + rsRandf(60.0f) - 30.0f;
+			newp.rgb = rgb;
+			newp.t = rsRandf(0.2f) + 0.1f;
+			newp.tr = newp.t;
+			newp.size = 8.0f * life;
+			newp.sprite = SPRITE_FLARE + 3;
+			newp.makeSmoke = 0;
 		}
 	}
 
@@ -1271,19 +1274,19 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		int sparks = int(sparkTrailLength);
 		sparkTrailLength -= float(sparks);
 		for(i=0; i<sparks; ++i){
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->drag = 0.342f;  // terminal velocity is 40 ft/s
-			newp->xyz = xyz;
-			newp->xyz[1] += rsRandf(inSettings->frameTime * 100.0f);
-			if(newp->xyz[1] > 50.0f)
-				newp->xyz[1] = 50.0f;
-			newp->vel.set(rsRandf(20.0f) - 10.0f,
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.drag = 0.342f;  // terminal velocity is 40 ft/s
+			newp.xyz = xyz;
+			newp.xyz[1] += rsRandf(inSettings->frameTime * 100.0f);
+			if(newp.xyz[1] > 50.0f)
+				newp.xyz[1] = 50.0f;
+			newp.vel.set(rsRandf(20.0f) - 10.0f,
 				rsRandf(30.0f) + 100.0f,
 				rsRandf(20.0f) - 10.0f);
-			newp->size = 10.0f;
-			newp->rgb = rgb;
-			newp->makeSmoke = 0;
+			newp.size = 10.0f;
+			newp.rgb = rgb;
+			newp.makeSmoke = 0;
 		}
 	}
 
@@ -1301,16 +1304,16 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		for(i=0; i<sparks; ++i){
 			spinquat.make(tilt + rsRandf(temp), tiltvec[0], tiltvec[1], tiltvec[2]);
 			spinquat.toMat(spinmat.m);
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->xyz = xyz;
-			newp->vel.set(vel[0] - (spinmat[0]*crossvec[0] + spinmat[4]*crossvec[1] + spinmat[8]*crossvec[2]) + rsRandf(20.0f) - 10.0f,
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.xyz = xyz;
+			newp.vel.set(vel[0] - (spinmat[0]*crossvec[0] + spinmat[4]*crossvec[1] + spinmat[8]*crossvec[2]) + rsRandf(20.0f) - 10.0f,
 				vel[1] - (spinmat[1]*crossvec[0] + spinmat[5]*crossvec[1] + spinmat[9]*crossvec[2]) + rsRandf(20.0f) - 10.0f,
 				vel[2] - (spinmat[2]*crossvec[0] + spinmat[6]*crossvec[1] + spinmat[10]*crossvec[2]) + rsRandf(20.0f) - 10.0f);
-			newp->size = 15.0f;
-			newp->rgb = rgb;
-			newp->makeSmoke = 0;
-			newp->t = newp->tr = rsRandf(0.5f) + 1.5f;
+			newp.size = 15.0f;
+			newp.rgb = rgb;
+			newp.makeSmoke = 0;
+			newp.t = newp.tr = rsRandf(0.5f) + 1.5f;
 		}
 		tilt += temp;
 	}
@@ -1324,18 +1327,18 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		int sparks = int(sparkTrailLength * 0.1f);
 		sparkTrailLength -= float(sparks) * 10.0f;
 		for(i=0; i<sparks; ++i){
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->xyz = xyz - (diff * rsRandf(1.0f));
-			newp->vel.set(vel[0] + rsRandf(50.0f) - 25.0f, 
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.xyz = xyz - (diff * rsRandf(1.0f));
+			newp.vel.set(vel[0] + rsRandf(50.0f) - 25.0f, 
 				vel[1] + rsRandf(50.0f) - 25.0f, 
 				vel[2] + rsRandf(50.0f) - 25.0f);
-			newp->rgb.set(1.0f, 0.7f, 0.4f);
-			newp->size = rsRandf(5.0f) + 5.0f;
-			newp->drag = 2.0f;
-			newp->t = newp->tr = rsRandf(2.0f) + 1.0f;
-			newp->tr = newp->t;
-			newp->makeSmoke = 0;
+			newp.rgb.set(1.0f, 0.7f, 0.4f);
+			newp.size = rsRandf(5.0f) + 5.0f;
+			newp.drag = 2.0f;
+			newp.t = newp.tr = rsRandf(2.0f) + 1.0f;
+			newp.tr = newp.t;
+			newp.makeSmoke = 0;
 		}
 	}
 
@@ -1348,17 +1351,17 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		int sparks = int(sparkTrailLength * 0.1f);
 		sparkTrailLength -= float(sparks) * 10.0f;
 		for(i=0; i<sparks; ++i){
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->xyz = xyz - (diff * rsRandf(1.0f));
-			newp->vel.set(vel[0] + rsRandf(100.0f) - 50.0f,
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.xyz = xyz - (diff * rsRandf(1.0f));
+			newp.vel.set(vel[0] + rsRandf(100.0f) - 50.0f,
 				vel[1] + rsRandf(100.0f) - 50.0f,
 				vel[2] + rsRandf(100.0f) - 50.0f);
-			newp->rgb = rgb;
-			newp->size = rsRandf(5.0f) + 5.0f;
-			newp->drag = 2.0f;
-			newp->t = newp->tr = rsRandf(0.5f) + 1.5f;
-			newp->makeSmoke = 0;
+			newp.rgb = rgb;
+			newp.size = rsRandf(5.0f) + 5.0f;
+			newp.drag = 2.0f;
+			newp.t = newp.tr = rsRandf(0.5f) + 1.5f;
+			newp.makeSmoke = 0;
 		}
 	}
 
@@ -1374,21 +1377,28 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 		float multiplier = 10.0f / sparkTrailLength;
 		for(i=0; i<sparks; i++){
 			smkpos += diff * multiplier;
-			newp = addParticle(inSettings);
-			newp->initStar(inSettings);
-			newp->xyz = smkpos;
-			newp->vel.set(rsRandf(100.0f) - 50.0f - vel[0] * 0.5f,
+			particle newp(addParticle(inSettings));
+			newp.initStar(inSettings);
+			newp.xyz = smkpos;
+			newp.vel.set(rsRandf(100.0f) - 50.0f - vel[0] * 0.5f,
 				rsRandf(100.0f) - 50.0f - vel[1] * 0.5f,
 				rsRandf(100.0f) - 50.0f - vel[2] * 0.5f);
-			newp->rgb = rgb;
-			newp->t = newp->tr = rsRandf(0.1f) + 0.15f;
-			newp->size = 7.0f;
-			newp->displayList = inSettings->flarelist[3];
-			newp->makeSmoke = 0;
+			newp.rgb = rgb;
+			newp.t = newp.tr = rsRandf(0.1f) + 0.15f;
+			newp.size = 7.0f;
+			newp.sprite = SPRITE_FLARE + 3;
+			newp.makeSmoke = 0;
 		}
 		sparkTrailLength -= float(sparks) * 10.0f;
 	}
 
+	// thrust sound from rockets
+	//if((type == ROCKET) && dSound)
+	//	insertSoundNode(THRUSTSOUND, xyz, cameraPos);
+}
+
+
+void particle::interact(SkyrocketSaverSettings *inSettings){
 	// smoke and cloud illumination from rockets and explosions
 	if(inSettings->dIllumination && ((type == ROCKET) || (type == FOUNTAIN) || (type == EXPLOSION)))
 		illuminate(this, inSettings);
@@ -1404,74 +1414,5 @@ void particle::update(SkyrocketSaverSettings *inSettings){
 	// stretching of particles by stretchers
 	if(type == STRETCHER)
 		stretching(this, inSettings);
-
-	// thrust sound from rockets
-	//if((type == ROCKET) && dSound)
-	//	insertSoundNode(THRUSTSOUND, xyz, cameraPos);
 }
 
-
-void particle::draw(SkyrocketSaverSettings *inSettings){
-	if(life <= 0.0f)
-		return;  // don't draw dead particles
-
-	// cull small particles that are behind camera
-	if(depth < 0.0f && type != SHOCKWAVE)
-		return;
-
-	// don't draw invisible particles
-	if(type == POPPER)
-		return;
-
-	glPushMatrix();
-	glTranslatef(xyz[0], xyz[1], xyz[2]);
-
-	switch(type){
-	case SHOCKWAVE:
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		glPushMatrix();
-			glScalef(size, size, size);
-			drawShockwave(life, float(sqrt(size)) * 0.05f, inSettings);
-		glPopMatrix();
-		glMultMatrixf(inSettings->billboardMat);
-		glScalef(size * 0.1f, size * 0.1f, size * 0.1f);
-		glColor4f(0.5f, 1.0f, 0.5f, bright);
-		glCallList(inSettings->flarelist[0]);
-		glScalef(0.35f, 0.35f, 0.35f);
-		glColor4f(1.0f, 1.0f, 1.0f, bright);
-		glCallList(inSettings->flarelist[0]);
-		if(life > 0.7f){  // Big torus just for fun
-			//glMultMatrixf(billboardMat);
-			glScalef(100.0f, 100.0f, 100.0f);
-			glColor4f(1.0f, life, 1.0f, (life - 0.7f) * 3.333f);
-			glCallList(inSettings->flarelist[2]);
-		}
-		break;
-	case SMOKE:
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glMultMatrixf(inSettings->billboardMat);
-		glScalef(size, size, size);
-		glColor4f(rgb[0], rgb[1], rgb[2], bright);
-		glCallList(displayList);
-		break;
-	case EXPLOSION:
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		glMultMatrixf(inSettings->billboardMat);
-		glScalef(size, size, size);
-		glColor4f(1.0f, 1.0f, 1.0f, bright);
-		glScalef(bright, bright, bright);
-		glCallList(displayList);
-		break;
-	default:
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		glMultMatrixf(inSettings->billboardMat);
-		glScalef(size, size, size);
-		glColor4f(rgb[0], rgb[1], rgb[2], bright);
-		glCallList(displayList);
-		glScalef(0.35f, 0.35f, 0.35f);
-		glColor4f(1.0f, 1.0f, 1.0f, bright);
-		glCallList(displayList);
-	}
-
-	glPopMatrix();
-}
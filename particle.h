@@ -32,12 +32,13 @@
 #include <Skyrocket/shockwave.h>
 #include <Skyrocket/SoundEngine.h>*/
 #include "rsMath.h"
-#include "flare.h"
 #include "smoke.h"
-#include "shockwave.h"
-#include "SoundEngine.h"
+#include "billboard.h"
+#include "soundevents.h"
+#include "particlestore.h"
 
 struct SkyrocketSaverSettings;
+class renderQueue;
 
 
 #define PI 3.14159265359f
@@ -64,7 +65,8 @@ struct SkyrocketSaverSettings;
 class particle;
 
 
-extern particle* addParticle(SkyrocketSaverSettings *inSettings);
+extern particle addParticle(SkyrocketSaverSettings *inSettings);
+extern int& currentSomeSmoke(SkyrocketSaverSettings *inSettings);
 
 extern void illuminate(particle* ill, SkyrocketSaverSettings *inSettings);
 extern void pulling(particle* suck, SkyrocketSaverSettings *inSettings);
@@ -83,43 +85,45 @@ extern float frameTime;
 extern rsVec cameraPos;  // used for positioning sounds
 extern float billboardMat[16];*/
 
-extern SoundEngine* soundengine;
-
 
+// A particle is a view of one slot in a particleStore.  Its members refer
+// straight into the store's arrays, so the functions below read and write the
+// store directly.  Don't hold on to one while the store might be resized.
 class particle{
 public:
-	unsigned int type; // choose type from #defines listed above
-	unsigned int displayList; // which object to draw (uses flare and rocket models)
-	rsVec xyz; // current position
-	rsVec lastxyz; // position from previous frame
-	rsVec vel; // velocity vector
-	rsVec rgb; // particle's color
-	float drag; // constant to represent air resistance
-	float t; // total time that particle lives
-	float tr; // time remaining
-	float bright; // intensity at which particle shines
-	float life; // life remaining (usually defined from 0.0 to 1.0)
-	float size; // scale factor by which to multiply the display list
+	unsigned int& type; // choose type from #defines listed above
+	unsigned int& sprite; // which sprite to draw (SPRITE_ value in billboard.h)
+	particleVec xyz; // current position
+	particleVec lastxyz; // position from previous frame
+	particleVec vel; // velocity vector
+	particleVec rgb; // particle's color
+	float& drag; // constant to represent air resistance
+	float& t; // total time that particle lives
+	float& tr; // time remaining
+	float& bright; // intensity at which particle shines
+	float& life; // life remaining (usually defined from 0.0 to 1.0)
+	float& size; // scale factor by which to multiply the display list
 	// rocket variables
-	float thrust; // constant to represent power of rocket
-	float endthrust; // point in rockets life at which to stop thrusting
-	float spin, tilt; // radial and pitch velocities to make rockets wobble when they go up
-	rsVec tiltvec; // vector about which a rocket tilts
-	int makeSmoke; // whether or not this particle produces smoke
-	int smokeTimeIndex; // which smoke time to use
-	float smokeTrailLength; // length that smoke particles must cover from one frame to the next.
+	float& thrust; // constant to represent power of rocket
+	float& endthrust; // point in rockets life at which to stop thrusting
+	float& spin; float& tilt; // radial and pitch velocities to make rockets wobble when they go up
+	particleVec tiltvec; // vector about which a rocket tilts
+	int& makeSmoke; // whether or not this particle produces smoke
+	int& smokeTimeIndex; // which smoke time to use
+	float& smokeTrailLength; // length that smoke particles must cover from one frame to the next.
 		// smokeTrailLength is stored so that remaining length from previous frame can be covered
 		// and no gaps are left in the smoke trail
-	float sparkTrailLength; // same for sparks from streamers
-	int explosiontype; // Type of explosion that a rocket will become when life runs out
+	float& sparkTrailLength; // same for sparks from streamers
+	int& explosiontype; // Type of explosion that a rocket will become when life runs out
 	// sorting variable
-	float depth;
+	float& depth;
 
-	// Constructor initializes particles to be stars because that's what most of them are
-	particle(SkyrocketSaverSettings *inSettings);
+	// Refer to particle i in store
+	particle(particleStore& store, unsigned int i);
 	~particle(){};
 	// A handy function for choosing an explosion's color
 	void randomColor(rsVec& color);
+	void randomColor(particleVec color);
 	// Initialization functions for particle types other than stars
 	void initStar(SkyrocketSaverSettings *inSettings);
 	void initStreamer(SkyrocketSaverSettings *inSettings);
@@ -153,12 +157,17 @@ public:
 	// Finds depth along camera's coordinate system's -z axis.
 	// Can be used for sorting and culling.
 	void findDepth(SkyrocketSaverSettings *inSettings);
-	// Update a particle according to frameTime
+	// Apply rocket thrust and bee acceleration.  Called before integrateParticles().
+	void accelerate(SkyrocketSaverSettings *inSettings);
+	// Update a particle according to frameTime, after integrateParticles() has
+	// moved it.  This only changes this particle and adds new ones, so different
+	// particles can be updated on different threads.
 	void update(SkyrocketSaverSettings *inSettings);
-	// Draw a particle
-	void draw(SkyrocketSaverSettings *inSettings);
-	// Return a pointer to this particle
-	particle* thisParticle(){return this;};
+	// Light, pull, push, or stretch other particles
+	void interact(SkyrocketSaverSettings *inSettings);
+	// Add whatever the particle looks like to a renderQueue (this one is in
+	// render.cpp)
+	void draw(renderQueue &queue, SkyrocketSaverSettings *inSettings);
 
 	// operators used by stl list sorting
 	friend bool operator < (const particle &p1, const particle &p2){return(p2.depth < p1.depth);}
@@ -168,5 +177,18 @@ public:
 };
 
 
+inline particle::particle(particleStore& store, unsigned int i)
+	: type(store.type[i]), sprite(store.sprite[i]),
+	xyz(store.xyz + i, store.capacity), lastxyz(store.lastxyz + i, store.capacity),
+	vel(store.vel + i, store.capacity), rgb(store.rgb + i, store.capacity),
+	drag(store.drag[i]), t(store.t[i]), tr(store.tr[i]), bright(store.bright[i]),
+	life(store.life[i]), size(store.size[i]), thrust(store.thrust[i]), endthrust(store.endthrust[i]),
+	spin(store.spin[i]), tilt(store.tilt[i]), tiltvec(store.tiltvec + i, store.capacity),
+	makeSmoke(store.makeSmoke[i]), smokeTimeIndex(store.smokeTimeIndex[i]),
+	smokeTrailLength(store.smokeTrailLength[i]), sparkTrailLength(store.sparkTrailLength[i]),
+	explosiontype(store.explosiontype[i]), depth(store.depth[i]){
+}
+
+
 
 #endif
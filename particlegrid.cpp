@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "particlegrid.h"
+#include "particle.h"
+#include "workerpool.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+
+// Cells are this big (in feet) unless the particles are so spread out that
+// there would be more cells than particles.  Light and force field radii are
+// 200 to 800 feet.
+#define GRIDCELL 200.0f
+// Fewer queries than this aren't worth sorting particles into cells for
+#define GRIDMINQUERIES 8
+
+
+
+particleGrid::particleGrid(){
+	cellSize = GRIDCELL;
+	origin[0] = origin[1] = origin[2] = 0.0f;
+	dims[0] = dims[1] = dims[2] = 0;
+	numParticles = 0;
+	numSmoke = 0;
+}
+
+
+void particleGrid::build(const particleStore &store, unsigned int count, unsigned int queries){
+	const unsigned int stride(store.capacity);
+	key.resize(count);
+	index.resize(count);
+	unsigned int* keys(count ? &key[0] : NULL);
+	unsigned int* sorted(count ? &index[0] : NULL);
+	const unsigned int* type(store.type);
+	numParticles = count;
+
+	if(queries < GRIDMINQUERIES){
+		// one cell; just put the smoke first
+		cellSize = 0.0f;
+		origin[0] = origin[1] = origin[2] = 0.0f;
+		dims[0] = dims[1] = dims[2] = 1;
+		start.assign(3, 0);
+		unsigned int smoke(0);
+		for(unsigned int i=0; i<count; ++i)
+			smoke += type[i] == SMOKE ? 1 : 0;
+		start[1] = smoke;
+		start[2] = count;
+		numSmoke = smoke;
+		unsigned int nextSmoke(0), nextOther(smoke);
+		for(unsigned int i=0; i<count; ++i){
+			if(type[i] == SMOKE)
+				sorted[nextSmoke++] = i;
+			else
+				sorted[nextOther++] = i;
+		}
+		return;
+	}
+
+	const float* x(store.xyz);
+	const float* y(store.xyz + stride);
+	const float* z(store.xyz + stride + stride);
+
+	// bounding box
+	float lo[3] = {0.0f, 0.0f, 0.0f};
+	float hi[3] = {0.0f, 0.0f, 0.0f};
+	if(count){
+		float lx(x[0]), ly(y[0]), lz(z[0]);
+		float hx(lx), hy(ly), hz(lz);
+		for(unsigned int i=1; i<count; ++i){
+			lx = x[i] < lx ? x[i] : lx;
+			hx = x[i] > hx ? x[i] : hx;
+			ly = y[i] < ly ? y[i] : ly;
+			hy = y[i] > hy ? y[i] : hy;
+			lz = z[i] < lz ? z[i] : lz;
+			hz = z[i] > hz ? z[i] : hz;
+		}
+		lo[0] = lx;  lo[1] = ly;  lo[2] = lz;
+		hi[0] = hx;  hi[1] = hy;  hi[2] = hz;
+		// A particle that flew off to infinity (or NaN, which the comparisons
+		// above mostly skip) would make the box endless.  Box just the finite
+		// particles; the rest are put in edge cells below.
+		if(!(hi[0] - lo[0] <= FLT_MAX && hi[1] - lo[1] <= FLT_MAX && hi[2] - lo[2] <= FLT_MAX)){
+			bool any(false);
+			for(unsigned int i=0; i<count; ++i){
+				const float p[3] = {x[i], y[i], z[i]};
+				if(!(fabsf(p[0]) <= FLT_MAX && fabsf(p[1]) <= FLT_MAX && fabsf(p[2]) <= FLT_MAX))
+					continue;
+				for(unsigned int j=0; j<3; ++j){
+					lo[j] = !any || p[j] < lo[j] ? p[j] : lo[j];
+					hi[j] = !any || p[j] > hi[j] ? p[j] : hi[j];
+				}
+				any = true;
+			}
+			if(!any)
+				lo[0] = lo[1] = lo[2] = hi[0] = hi[1] = hi[2] = 0.0f;
+		}
+	}
+
+	// Clearing and summing the cells costs about as much as sorting the
+	// particles, so there is no point in having more cells than particles.
+	const float maxCells(count > 64 ? float(count) : 64.0f);
+	float n[3];
+	cellSize = GRIDCELL;
+	while(1){
+		for(unsigned int j=0; j<3; ++j)
+			n[j] = floorf((hi[j] - lo[j]) / cellSize) + 1.0f;
+		if(n[0] * n[1] * n[2] <= maxCells)
+			break;
+		cellSize *= 2.0f;
+		// can't happen with a finite box, but never loop forever
+		if(!(cellSize <= FLT_MAX)){
+			cellSize = FLT_MAX;
+			n[0] = n[1] = n[2] = 1.0f;
+			break;
+		}
+	}
+	for(unsigned int j=0; j<3; ++j){
+		origin[j] = lo[j];
+		dims[j] = (unsigned int)(n[j]);
+	}
+
+	// counting sort of particles by cell
+	const unsigned int cells(dims[0] * dims[1] * dims[2]);
+	start.assign(cells * 2 + 1, 0);
+	// locals, so the compiler knows the stores below don't change them
+	const float ox(origin[0]), oy(origin[1]), oz(origin[2]);
+	const float mx(float(dims[0] - 1)), my(float(dims[1] - 1)), mz(float(dims[2] - 1));
+	const unsigned int rowSize(dims[0]), sliceSize(dims[0] * dims[1]);
+	const float scale(1.0f / cellSize);
+	unsigned int* counts(&start[1]);
+	unsigned int smoke(0);
+	for(unsigned int i=0; i<count; ++i){
+		// clamped before converting, so that particles outside the box (only
+		// infinite or NaN ones) land in an edge cell
+		float fx((x[i] - ox) * scale);
+		float fy((y[i] - oy) * scale);
+		float fz((z[i] - oz) * scale);
+		fx = fx > 0.0f ? (fx < mx ? fx : mx) : 0.0f;
+		fy = fy > 0.0f ? (fy < my ? fy : my) : 0.0f;
+		fz = fz > 0.0f ? (fz < mz ? fz : mz) : 0.0f;
+		const unsigned int cx(fx), cy(fy), cz(fz);
+		const unsigned int notSmoke(type[i] == SMOKE ? 0 : 1);
+		smoke += 1 - notSmoke;
+		keys[i] = (cz * sliceSize + cy * rowSize + cx) * 2 + notSmoke;
+		++counts[keys[i]];
+	}
+	numSmoke = smoke;
+	for(unsigned int k=1; k<=cells*2; ++k)
+		start[k] += start[k - 1];
+	found.assign(start.begin(), start.end() - 1);  // next free spot in each bucket
+	unsigned int* next(&found[0]);
+	for(unsigned int i=0; i<count; ++i)
+		sorted[next[keys[i]]++] = i;
+	found.clear();
+}
+
+
+unsigned int particleGrid::find(float x, float y, float z, float radius, int which, const unsigned int* &list){
+	if(cellSize == 0.0f)  // one cell
+		return cellParticles(0, which, list);
+
+	found.clear();
+	list = NULL;
+	unsigned int lo[3], hi[3];
+	if(!findCells(x, y, z, radius, lo, hi))
+		return 0;
+	for(unsigned int cz=lo[2]; cz<=hi[2]; ++cz){
+		for(unsigned int cy=lo[1]; cy<=hi[1]; ++cy){
+			const unsigned int row(cell(0, cy, cz));
+			if(which == GRID_ALL){
+				// a row of cells is contiguous in index
+				found.insert(found.end(), index.begin() + start[(row + lo[0]) * 2],
+					index.begin() + start[(row + hi[0]) * 2 + 2]);
+			}
+			else{
+				for(unsigned int cx=lo[0]; cx<=hi[0]; ++cx){
+					const unsigned int c((row + cx) * 2);
+					found.insert(found.end(), index.begin() + start[c], index.begin() + start[c + 1]);
+				}
+			}
+		}
+	}
+	if(!found.empty())
+		list = &found[0];
+	return found.size();
+}
+
+
+bool particleGrid::findCells(float x, float y, float z, float radius, unsigned int lo[3], unsigned int hi[3]) const{
+	if(cellSize == 0.0f){  // one cell
+		lo[0] = lo[1] = lo[2] = hi[0] = hi[1] = hi[2] = 0;
+		return true;
+	}
+
+	// pad the radius a little so rounding never leaves out a particle on a cell edge
+	radius += 1.0f;
+	const float pos[3] = {x, y, z};
+	for(unsigned int j=0; j<3; ++j){
+		const float a((pos[j] - radius - origin[j]) / cellSize);
+		const float b((pos[j] + radius - origin[j]) / cellSize);
+		// written so that NaN finds nothing
+		if(!(b >= 0.0f && a < float(dims[j])))
+			return false;
+		lo[j] = a < 0.0f ? 0 : (unsigned int)(a);
+		hi[j] = b >= float(dims[j]) ? dims[j] - 1 : (unsigned int)(b);
+	}
+	return true;
+}
+
+
+unsigned int particleGrid::cellParticles(unsigned int c, int which, const unsigned int* &list) const{
+	const unsigned int first(start[c * 2]);
+	const unsigned int last(start[c * 2 + (which == GRID_ALL ? 2 : 1)]);
+	list = first < last ? &index[first] : NULL;
+	return last - first;
+}
+
+
+// What dealCells() hands to each job
+struct cellDeal{
+	const particleGrid* grid;
+	void (*cellFunc)(unsigned int c, void* data);
+	void* data;
+	unsigned int jobs;
+};
+
+
+void particleGrid::dealCells(workerPool* workers, unsigned int work, unsigned int perJob,
+	void (*cellFunc)(unsigned int c, void* data), void* data) const{
+	cellDeal deal;
+	deal.grid = this;
+	deal.cellFunc = cellFunc;
+	deal.data = data;
+	deal.jobs = std::max(1u, std::min(work / perJob, workers->size()));
+	if(deal.jobs > 1)
+		workers->run(dealJob, &deal);
+	else
+		dealJob(0, &deal);
+}
+
+
+void particleGrid::dealJob(unsigned int job, void* data){
+	const cellDeal& deal(*(cellDeal*)data);
+	if(job >= deal.jobs)  // the pool always runs all its jobs
+		return;
+	const unsigned int cells(deal.grid->numCells());
+	for(unsigned int c=job; c<cells; c+=deal.jobs)
+		deal.cellFunc(c, deal.data);
+}
+
+
+void cellBins::sort(const unsigned int dims[3]){
+	const unsigned int cells(dims[0] * dims[1] * dims[2]);
+	start.assign(cells + 1, 0);
+	for(int pass=0; pass<2; ++pass){
+		for(unsigned int n=0; n<boxes.size(); ++n){
+			const cellBox& box(boxes[n]);
+			if(!box.any)
+				continue;
+			for(unsigned int z=box.lo[2]; z<=box.hi[2]; ++z){
+				for(unsigned int y=box.lo[1]; y<=box.hi[1]; ++y){
+					for(unsigned int x=box.lo[0]; x<=box.hi[0]; ++x){
+						const unsigned int c((z * dims[1] + y) * dims[0] + x);
+						if(pass == 0)
+							++start[c + 1];
+						else
+							index[start[c]++] = n;
+					}
+				}
+			}
+		}
+		if(pass == 0){
+			for(unsigned int c=0; c<cells; ++c)
+				start[c + 1] += start[c];
+			index.resize(start[cells]);
+		}
+	}
+	// the second pass moved every cell's start up to the next cell's start
+	for(unsigned int c=cells; c>0; --c)
+		start[c] = start[c - 1];
+	start[0] = 0;
+}
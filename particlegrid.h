@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PARTICLEGRID_H
+#define PARTICLEGRID_H
+
+
+
+#include "particlestore.h"
+#include <vector>
+
+class workerPool;
+
+
+// Which particles particleGrid::find() returns
+#define GRID_SMOKE 0
+#define GRID_ALL 1
+
+
+// Uniform grid over particle positions, rebuilt every frame after the particles
+// are updated, so that lights and force fields only have to look at the
+// particles near them instead of all of them.  The grid covers the particles'
+// bounding box.  Smoke is kept separate from the other particles in each cell
+// because only smoke gets illuminated.
+class particleGrid{
+public:
+	float cellSize;
+	float origin[3];  // lowest corner of the grid
+	unsigned int dims[3];  // number of cells along x, y, and z
+	unsigned int numParticles;  // particles in the grid
+	unsigned int numSmoke;  // SMOKE particles in the grid
+
+	particleGrid();
+	// Sort the first count particles of store into cells.  queries is about how
+	// many times find() will be called; with only a few, sorting costs more than
+	// it saves, so everything goes in one cell.  The grid is only good until the
+	// particles move or the store changes.
+	void build(const particleStore &store, unsigned int count, unsigned int queries);
+	// Find particles in cells within radius of (x, y, z).  These are candidates;
+	// the caller still has to check distances.  Sets list to their indices and
+	// returns how many there are.  The list is good until the next call.
+	unsigned int find(float x, float y, float z, float radius, int which, const unsigned int* &list);
+	// Cells lo to hi (inclusive) along each axis are the ones within radius of
+	// (x, y, z).  Returns false if there are none.
+	bool findCells(float x, float y, float z, float radius, unsigned int lo[3], unsigned int hi[3]) const;
+	unsigned int numCells() const {return dims[0] * dims[1] * dims[2];}
+	unsigned int cell(unsigned int x, unsigned int y, unsigned int z) const
+		{return (z * dims[1] + y) * dims[0] + x;}
+	// Particles in cell c.  Sets list to their indices and returns how many there are.
+	unsigned int cellParticles(unsigned int c, int which, const unsigned int* &list) const;
+	// Call cellFunc(c, data) for every cell c.  Uses the worker threads when
+	// there are at least perJob units of work (particles, usually) per thread.
+	// Cells are dealt out to the jobs like cards so each gets a share of the
+	// busy ones.
+	void dealCells(workerPool* workers, unsigned int work, unsigned int perJob,
+		void (*cellFunc)(unsigned int c, void* data), void* data) const;
+
+private:
+	// Particles sorted by cell, smoke first.  Cell c's smoke goes from
+	// index[start[2*c]] to index[start[2*c+1]] and its other particles go
+	// up to index[start[2*c+2]].
+	std::vector<unsigned int> start;
+	std::vector<unsigned int> index;
+	std::vector<unsigned int> key;  // 2 * cell, plus 1 if not smoke, for each particle
+	std::vector<unsigned int> found;
+
+	static void dealJob(unsigned int job, void* data);
+};
+
+
+// Cells lo to hi (inclusive) along each axis that one item reaches
+struct cellBox{
+	unsigned int lo[3], hi[3];
+	bool any;  // false if the item reaches no cells at all
+};
+
+
+// Items (lights, force fields) sorted into the cells of a grid that they
+// reach, keeping them in order, so that each cell only has to look at the
+// items near it.
+class cellBins{
+public:
+	std::vector<cellBox> boxes;  // one per item
+
+	// Sort the items in boxes into the cells of a grid dims cells across
+	void sort(const unsigned int dims[3]);
+	// Sort items with an xyz into the cells of grid within reach(item) of them
+	template<class T, class F> void sort(const particleGrid &grid, const std::vector<T> &items, F reach){
+		boxes.resize(items.size());
+		for(unsigned int n=0; n<items.size(); ++n){
+			const T& item(items[n]);
+			cellBox& box(boxes[n]);
+			box.any = grid.findCells(item.xyz[0], item.xyz[1], item.xyz[2], reach(item), box.lo, box.hi);
+		}
+		sort(grid.dims);
+	}
+	// Items that reach cell c.  Sets list to their indices and returns how many there are.
+	unsigned int cellItems(unsigned int c, const unsigned int* &list) const{
+		list = start[c] < start[c + 1] ? &index[start[c]] : NULL;
+		return start[c + 1] - start[c];
+	}
+
+private:
+	// Cell c's items are index[start[c]] up to index[start[c+1]]
+	std::vector<unsigned int> start;
+	std::vector<unsigned int> index;
+};
+
+
+
+#endif
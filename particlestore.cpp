@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "particlestore.h"
+#include "Skyrocket.h"
+#include "billboard.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+// Every field is 4 bytes wide.  This is the number of arrays in a store,
+// counting each vector field as three.
+#define STOREARRAYS 33
+// Capacity is kept at a multiple of this so every array starts on a 64-byte boundary
+#define STOREALIGN 16
+
+
+
+particleStore::particleStore(){
+	capacity = 0;
+	block = NULL;
+	setPointers(NULL, 0);
+}
+
+
+particleStore::~particleStore(){
+	clear();
+}
+
+
+void particleStore::setPointers(void* mem, unsigned int cap){
+	float* p = (float*)mem;
+	type = (unsigned int*)p;		p += cap;
+	sprite = (unsigned int*)p;	p += cap;
+	xyz = p;						p += cap * 3;
+	lastxyz = p;					p += cap * 3;
+	vel = p;						p += cap * 3;
+	rgb = p;						p += cap * 3;
+	drag = p;						p += cap;
+	t = p;							p += cap;
+	tr = p;							p += cap;
+	bright = p;						p += cap;
+	life = p;						p += cap;
+	size = p;						p += cap;
+	thrust = p;						p += cap;
+	endthrust = p;					p += cap;
+	spin = p;						p += cap;
+	tilt = p;						p += cap;
+	tiltvec = p;					p += cap * 3;
+	makeSmoke = (int*)p;			p += cap;
+	smokeTimeIndex = (int*)p;		p += cap;
+	smokeTrailLength = p;			p += cap;
+	sparkTrailLength = p;			p += cap;
+	explosiontype = (int*)p;		p += cap;
+	depth = p;
+}
+
+
+int particleStore::resize(unsigned int newSize, SkyrocketSaverSettings *inSettings){
+	const unsigned int newCapacity((newSize + STOREALIGN - 1) & ~(STOREALIGN - 1));
+	if(newCapacity <= capacity)
+		return 1;
+
+	void* mem;
+	if(posix_memalign(&mem, 64, size_t(newCapacity) * STOREARRAYS * 4))
+		return 0;
+	memset(mem, 0, size_t(newCapacity) * STOREARRAYS * 4);
+
+	// move existing particles into the new arrays
+	if(block){
+		for(unsigned int i=0; i<STOREARRAYS; ++i)
+			memcpy((float*)mem + size_t(i) * newCapacity, (float*)block + size_t(i) * capacity, size_t(capacity) * 4);
+		free(block);
+	}
+	const unsigned int oldCapacity(capacity);
+	block = mem;
+	capacity = newCapacity;
+	setPointers(block, capacity);
+
+	// New slots are initialized to be stars because that's what most of them are
+	for(unsigned int i=oldCapacity; i<capacity; ++i)
+		reset(i, inSettings);
+	return 1;
+}
+
+
+void particleStore::reset(unsigned int i, SkyrocketSaverSettings *inSettings){
+	type[i] = STAR;
+	sprite[i] = SPRITE_FLARE;
+	drag[i] = 0.612f;  // terminal velocity of 20 ft/s
+	t[i] = 2.0f;
+	tr[i] = t[i];
+	bright[i] = 1.0f;
+	life[i] = bright[i];
+	size[i] = 30.0f;
+	makeSmoke[i] = 0;
+	smokeTimeIndex[i] = 0;
+	smokeTrailLength[i] = 0.0f;
+	sparkTrailLength[i] = 0.0f;
+	depth[i] = 0.0f;
+	// Nothing is left over from whatever used the slot before.  Some particles
+	// (little poppers) never set their color, and a leftover one would depend
+	// on which slot, and so which thread's spawn queue, they landed in.
+	for(unsigned int j=0; j<3; ++j){
+		xyz[j * capacity + i] = 0.0f;
+		lastxyz[j * capacity + i] = 0.0f;
+		vel[j * capacity + i] = 0.0f;
+		rgb[j * capacity + i] = 0.0f;
+		tiltvec[j * capacity + i] = 0.0f;
+	}
+	thrust[i] = 0.0f;
+	endthrust[i] = 0.0f;
+	spin[i] = 0.0f;
+	tilt[i] = 0.0f;
+	explosiontype[i] = 0;
+}
+
+
+void particleStore::copy(unsigned int dst, unsigned int src){
+	float* p = (float*)block;
+	for(unsigned int i=0; i<STOREARRAYS; ++i){
+		memcpy(p + dst, p + src, 4);
+		p += capacity;
+	}
+}
+
+
+void particleStore::copy(unsigned int dst, const particleStore &src, unsigned int srcStart, unsigned int count){
+	float* p = (float*)block + dst;
+	const float* q = (const float*)src.block + srcStart;
+	for(unsigned int i=0; i<STOREARRAYS; ++i){
+		memcpy(p, q, size_t(count) * 4);
+		p += capacity;
+		q += src.capacity;
+	}
+}
+
+
+void particleStore::clear(){
+	free(block);
+	block = NULL;
+	capacity = 0;
+	setPointers(NULL, 0);
+}
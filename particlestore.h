@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef PARTICLESTORE_H
+#define PARTICLESTORE_H
+
+
+
+#include <vector>
+#include "rsMath.h"
+
+struct SkyrocketSaverSettings;
+
+
+// Stand-in for an rsVec that lives inside a particleStore.  The x, y, and z
+// components sit in separate arrays, "stride" floats apart, so this just points
+// at the x component and behaves like an rsVec for the particle code.
+class particleVec{
+public:
+	float* v;
+	unsigned int stride;
+
+	particleVec(float* vec, unsigned int s) : v(vec), stride(s) {}
+	particleVec(const particleVec &vec) : v(vec.v), stride(vec.stride) {}
+
+	float & operator [] (int i) {return v[i * stride];}
+	const float & operator [] (int i) const {return v[i * stride];}
+	operator rsVec () const
+		{return(rsVec(v[0], v[stride], v[stride + stride]));}
+
+	void set(float xx, float yy, float zz)
+		{v[0] = xx; v[stride] = yy; v[stride + stride] = zz;}
+	float length()
+		{return(rsVec(*this).length());}
+	float normalize()
+		{rsVec vec(*this); const float len(vec.normalize()); *this = vec; return len;}
+	float dot(rsVec vec)
+		{return(v[0]*vec[0] + v[stride]*vec[1] + v[stride + stride]*vec[2]);}
+	void cross(rsVec vec1, rsVec vec2)
+		{rsVec vec; vec.cross(vec1, vec2); *this = vec;}
+	void transVec(const rsMatrix &m)
+		{rsVec vec(*this); vec.transVec(m); *this = vec;}
+
+	// Assignment copies values; it never re-points the reference
+	particleVec & operator = (const particleVec &vec)
+		{set(vec[0], vec[1], vec[2]); return *this;}
+	particleVec & operator = (const rsVec &vec)
+		{set(vec[0], vec[1], vec[2]); return *this;}
+	rsVec operator + (const rsVec &vec) const
+		{return(rsVec(v[0]+vec[0], v[stride]+vec[1], v[stride + stride]+vec[2]));}
+	rsVec operator - (const rsVec &vec) const
+		{return(rsVec(v[0]-vec[0], v[stride]-vec[1], v[stride + stride]-vec[2]));}
+	rsVec operator * (const float &mul) const
+		{return(rsVec(v[0]*mul, v[stride]*mul, v[stride + stride]*mul));}
+	particleVec & operator += (const rsVec &vec)
+		{v[0]+=vec[0]; v[stride]+=vec[1]; v[stride + stride]+=vec[2]; return *this;}
+	particleVec & operator -= (const rsVec &vec)
+		{v[0]-=vec[0]; v[stride]-=vec[1]; v[stride + stride]-=vec[2]; return *this;}
+	particleVec & operator *= (const float &mul)
+		{v[0]*=mul; v[stride]*=mul; v[stride + stride]*=mul; return *this;}
+};
+
+
+// Structure-of-arrays storage for every particle in the show.  Each field gets
+// its own contiguous, 64-byte aligned array so that passes which only look at a
+// few fields (type, life, position) don't drag whole particles through the cache.
+// Vector fields are three consecutive arrays:  all x, then all y, then all z.
+// Use the particle class (particle.h) to work with one particle at a time.
+class particleStore{
+public:
+	unsigned int capacity;  // number of slots in every array
+	// per-particle fields (see the particle class for descriptions)
+	unsigned int* type;
+	unsigned int* sprite;
+	float* xyz;
+	float* lastxyz;
+	float* vel;
+	float* rgb;
+	float* drag;
+	float* t;
+	float* tr;
+	float* bright;
+	float* life;
+	float* size;
+	float* thrust;
+	float* endthrust;
+	float* spin;
+	float* tilt;
+	float* tiltvec;
+	int* makeSmoke;
+	int* smokeTimeIndex;
+	float* smokeTrailLength;
+	float* sparkTrailLength;
+	int* explosiontype;
+	float* depth;
+
+	particleStore();
+	~particleStore();
+	// Grow the arrays to hold at least newSize particles.  Existing slots keep
+	// their contents and new slots are initialized as stars.  Returns 0 if the
+	// memory couldn't be allocated, in which case the store keeps its old
+	// arrays and capacity.
+	int resize(unsigned int newSize, SkyrocketSaverSettings *inSettings);
+	// Initialize particle i as a star
+	void reset(unsigned int i, SkyrocketSaverSettings *inSettings);
+	// Copy every field of particle src into particle dst
+	void copy(unsigned int dst, unsigned int src);
+	// Copy count particles starting at srcStart in another store to dst and
+	// onward in this one.  Both ranges must fit in their stores.
+	void copy(unsigned int dst, const particleStore &src, unsigned int srcStart, unsigned int count);
+	// Free all arrays
+	void clear();
+
+private:
+	void* block;  // one allocation holds all the arrays
+
+	void setPointers(void* mem, unsigned int cap);
+	particleStore(const particleStore&);
+	particleStore & operator = (const particleStore&);
+};
+
+
+
+// Spawns in a spawnQueue that all came from one chunk of particles
+struct spawnRun{
+	unsigned int chunk;  // chunk of the update range (see updateParticles())
+	unsigned int first, count;  // slots in the queue
+};
+
+
+// Particles spawned by one update thread.  Every thread that runs
+// particle::update() gets its own queue, so threads never share a write
+// position.  Each queue remembers which chunk of particles made which of its
+// spawns, and the spawns are merged into the live set in chunk order
+// afterwards, whichever thread made them.
+class spawnQueue{
+public:
+	particleStore store;  // last slot is scratch space for spawns that don't fit
+	unsigned int last;  // number of queued particles
+	unsigned int dropped;  // spawns lost because the queue was full
+	std::vector<spawnRun> runs;  // in the order they were made
+
+	spawnQueue() : last(0), dropped(0) {}
+};
+
+
+// Random numbers and smoke choices for one chunk of the particles being
+// updated.  A chunk always uses the same stream, whichever thread updates it,
+// so a seeded show plays out the same with any number of threads.
+class updateStream{
+public:
+	rsRandom random;
+	int someSmoke;  // which entry of whichSmoke the next star uses
+
+	updateStream() : someSmoke(0) {}
+};
+
+
+
+#endif
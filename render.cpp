@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// Skyrocket screen saver:  OpenGL drawing and sound.  Everything in here only
+// looks at the show that updateSim() (Skyrocket.cpp) has left in the settings.
+
+
+#include "Skyrocket.h"
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#include "rsText.h"
+#include <math.h>
+#include <vector>
+#include "rsMath.h"
+#include "particle.h"
+#include "world.h"
+#include "flare.h"
+#include "smoke.h"
+#include "shockwave.h"
+#include "oit.h"
+#include "lensflare.h"
+#include "renderqueue.h"
+#include "SoundEngine.h"
+
+// the sound engine
+SoundEngine* soundengine = NULL;
+
+// everything to draw in front of the world this frame
+static renderQueue queue;
+
+
+
+// Load the camera's matrices from viewMatrices()
+static void loadViewMatrices(SkyrocketSaverSettings *inSettings){
+	viewMatrices(inSettings);
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixd(inSettings->projMat);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixd(inSettings->modelMat);
+}
+
+
+__private_extern__ void draw(SkyrocketSaverSettings * inSettings){
+	// Variables for printing text
+	static float computeTime = 0.0f;
+	static float drawTime = 0.0f;
+	//static rsTimer computeTimer, drawTimer;
+	// start compute time timer
+	//computeTimer.tick();
+
+	const float elapsed(inSettings->frameTime);
+	stepSim(elapsed, inSettings);
+
+	// Camera, part way between the last two ticks
+	loadViewMatrices(inSettings);
+	const float t(inSettings->tickFraction);
+	// only particles in view get drawn
+	inSettings->onScreen.cull(inSettings->particles, inSettings->last_particle, inSettings->modelMat,
+		inSettings->projMat, inSettings->kFireworks ? t : 1.0f, inSettings->dSimd);
+	// Only smoke is blended in a way that depends on drawing order, and weighted
+	// blended transparency doesn't depend on it at all
+	if(inSettings->dSmokeBlend == SMOKEBLEND_SORT)
+		inSettings->smokeOrder.sort(inSettings->particles, inSettings->onScreen.visible,
+			inSettings->modelMat, inSettings->kFireworks ? t : 1.0f);
+
+	// clear the screen
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// measure compute time
+	//computeTime += computeTimer.tick();
+	// start draw time timer
+	//drawTimer.tick();
+
+	// the world
+	inSettings->theWorld->draw(inSettings);
+
+	// draw particles and lens flares
+	queue.clear();
+	queue.addParticles(inSettings);
+	if(inSettings->dFlare && inSettings->dFlareStyle == FLARESTYLE_SPRITES){
+		inSettings->lensFlares.find(inSettings);
+		const std::vector<flareData>& flares(inSettings->lensFlares.flares);
+		for(unsigned int i=0; i<flares.size(); ++i)
+			flare(flares[i].x, flares[i].y, flares[i].r, flares[i].g, flares[i].b, flares[i].a,
+				queue.flares, inSettings);
+	}
+	queue.draw(inSettings);
+
+	// measure draw time
+	//drawTime += drawTimer.tick();
+
+	// do sound stuff
+	if(soundengine){
+		for(unsigned int i=0; i<inSettings->soundEvents.size(); ++i){
+			const soundEvent &event(inSettings->soundEvents[i]);
+			soundengine->insertSoundNode(event.sound, rsVec(event.pos[0], event.pos[1], event.pos[2]), inSettings->cameraPos);
+		}
+		float listenerOri[6];
+		listenerOri[0] = float(-(inSettings->modelMat[2]));
+		listenerOri[1] = float(-(inSettings->modelMat[6]));
+		listenerOri[2] = float(-(inSettings->modelMat[10]));
+		listenerOri[3] = float(inSettings->modelMat[1]);
+		listenerOri[4] = float(inSettings->modelMat[5]);
+		listenerOri[5] = float(inSettings->modelMat[9]);
+		soundengine->update(inSettings->cameraPos.v, inSettings->cameraVel.v, listenerOri, inSettings->frameTime, inSettings->kSlowMotion);
+	}
+
+	//draw_overlay(frameTime);
+
+	// print text
+	static float totalTime = 0.0f;
+	totalTime += elapsed;
+	static std::vector<std::string> strvec;
+	static int frames = 0;
+	++frames;
+	if(frames == 20){
+		strvec.clear();
+		std::string str1 = "         FPS = " + to_string(20.0f / totalTime);
+		strvec.push_back(str1);
+		std::string str2 = "compute time = " + to_string(computeTime / 20.0f);
+		strvec.push_back(str2);
+		std::string str3 = "   draw time = " + to_string(drawTime / 20.0f);
+		strvec.push_back(str3);
+		std::string str4 = "   particles = " + to_string(inSettings->last_particle);
+		strvec.push_back(str4);
+		std::string str5 = "     dropped = " + to_string(inSettings->droppedParticles);
+		strvec.push_back(str5);
+		std::string str6 = "  draw calls = " + to_string(queue.drawCalls);
+		strvec.push_back(str6);
+		std::string str7 = "  GL changes = " + to_string(queue.stateChanges);
+		strvec.push_back(str7);
+		totalTime = 0.0f;
+		computeTime = 0.0f;
+		drawTime = 0.0f;
+		frames = 0;
+	}
+
+	if(inSettings->kStatistics){
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho(0.0f, 50.0f * inSettings->aspectRatio, 0.0f, 50.0f, -1.0f, 1.0f);
+
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		glTranslatef(1.0f, 48.0f, 0.0f);
+
+		glColor3f(1.0f, 0.6f, 0.0f);
+		inSettings->textwriter->draw(strvec);
+
+		glPopMatrix();
+		glMatrixMode(GL_PROJECTION);
+		glPopMatrix();
+	}
+
+	//wglSwapLayerBuffers(hdc, WGL_SWAP_MAIN_PLANE);
+}
+
+
+void initSaver(int width, int height,SkyrocketSaverSettings * inSettings){
+	// Window initialization
+	glViewport(0, 0, width, height);
+
+	// Set OpenGL state
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_TEXTURE_2D);
+	glFrontFace(GL_CCW);
+	glEnable(GL_CULL_FACE);
+
+	initFlares(inSettings);
+	initSim(width, height, inSettings);
+	loadViewMatrices(inSettings);
+
+	// Textures and stars get their own random numbers so that a seeded show
+	// plays out the same with or without anything to draw it
+	rsRandom textureRandom;
+	textureRandom.seed(~uint64_t(inSettings->seed));
+	rsCurrentRandom = &textureRandom;
+	if(inSettings->dSmoke)
+		initSmoke(inSettings);
+	if(inSettings->dSmokeBlend == SMOKEBLEND_WEIGHTED && !initOit(width, height))
+		inSettings->dSmokeBlend = SMOKEBLEND_SORT;
+	if(inSettings->dFlareStyle == FLARESTYLE_SCREEN && !initLensFlare(width, height))
+		inSettings->dFlareStyle = FLARESTYLE_SPRITES;
+	initBillboards();
+	inSettings->theWorld->initGL(inSettings);
+	initShockwave();
+	rsCurrentRandom = &inSettings->random;
+
+	inSettings->textwriter = new rsText;
+	if(inSettings->dSound && soundengine == NULL)
+		soundengine = new SoundEngine(float(inSettings->dSound) * 0.01f);
+}
+
+
+__private_extern__ void reshape(int width, int height, SkyrocketSaverSettings * inSettings){
+	glViewport(0, 0, width, height);
+	resizeSim(width, height, inSettings);
+	if(inSettings->dSmokeBlend == SMOKEBLEND_WEIGHTED)
+		resizeOit(width, height);
+	if(inSettings->dFlareStyle == FLARESTYLE_SCREEN)
+		resizeLensFlare(width, height);
+}
+
+
+__private_extern__ void cleanup(SkyrocketSaverSettings * inSettings)
+{
+	// before cleanupSim() deletes the world
+	inSettings->theWorld->cleanupGL();
+	cleanupSim(inSettings);
+	cleanupOit();
+	cleanupLensFlare();
+	cleanupBillboards();
+	cleanupShockwave();
+	delete inSettings->textwriter;
+	inSettings->textwriter = NULL;
+	
+	// clean up sound data structures
+	if(inSettings->dSound)
+	{
+		delete soundengine;
+		soundengine = NULL;
+	}
+}
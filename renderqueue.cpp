@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <OpenGL/gl.h>
+#include <math.h>
+#include "renderqueue.h"
+#include "Skyrocket.h"
+#include "world.h"
+#include "shockwave.h"
+#include "oit.h"
+#include "lensflare.h"
+#include "particle.h"
+
+
+
+// Where to draw a particle.  Between simulation ticks (see stepSim()) this is
+// part way from where the particle was at the last tick to where it is now.
+static rsVec drawPosition(const particle &part, SkyrocketSaverSettings *inSettings){
+	const float t(inSettings->tickFraction);
+	if(t >= 1.0f || !inSettings->kFireworks || part.type == FOUNTAIN)
+		return part.xyz;
+	return part.lastxyz + (part.xyz - part.lastxyz) * t;
+}
+
+
+static void addBillboard(std::vector<billboard> &billboards, const rsVec &pos, float size,
+	float red, float green, float blue, float alpha, unsigned int sprite){
+	billboard b;
+	b.xyz[0] = pos[0];
+	b.xyz[1] = pos[1];
+	b.xyz[2] = pos[2];
+	b.size = size;
+	b.rgba[0] = red;
+	b.rgba[1] = green;
+	b.rgba[2] = blue;
+	b.rgba[3] = alpha;
+	b.sprite = float(sprite);
+	billboards.push_back(b);
+}
+
+
+void particle::draw(renderQueue &queue, SkyrocketSaverSettings *inSettings){
+	if(life <= 0.0f)
+		return;  // don't draw dead particles
+
+	// cull small particles that are behind camera
+	if(depth < 0.0f && type != SHOCKWAVE)
+		return;
+
+	// don't draw invisible particles
+	if(type == POPPER)
+		return;
+
+	rsVec pos(drawPosition(*this, inSettings));
+
+	switch(type){
+	case SHOCKWAVE:{
+		shockwaveRing ring;
+		ring.xyz[0] = pos[0];
+		ring.xyz[1] = pos[1];
+		ring.xyz[2] = pos[2];
+		ring.size = size;
+		ring.life = life;
+		queue.shockwaves.push_back(ring);
+		addBillboard(queue.glow, pos, size * 0.1f, 0.5f, 1.0f, 0.5f, bright, SPRITE_FLARE);
+		addBillboard(queue.glow, pos, size * 0.035f, 1.0f, 1.0f, 1.0f, bright, SPRITE_FLARE);
+		if(life > 0.7f)  // Big torus just for fun
+			addBillboard(queue.glow, pos, size * 3.5f, 1.0f, life, 1.0f, (life - 0.7f) * 3.333f, SPRITE_FLARE + 2);
+		break;
+	}
+	case SMOKE:
+		addBillboard(queue.smoke, pos, size, rgb[0], rgb[1], rgb[2], bright, sprite);
+		break;
+	case EXPLOSION:
+		addBillboard(queue.glow, pos, size * bright, 1.0f, 1.0f, 1.0f, bright, sprite);
+		break;
+	default:
+		addBillboard(queue.glow, pos, size, rgb[0], rgb[1], rgb[2], bright, sprite);
+		addBillboard(queue.glow, pos, size * 0.35f, 1.0f, 1.0f, 1.0f, bright, sprite);
+	}
+}
+
+
+
+void renderQueue::clear(){
+	smoke.clear();
+	shockwaves.clear();
+	glow.clear();
+	flares.clear();
+}
+
+
+void renderQueue::addParticles(SkyrocketSaverSettings *inSettings){
+	const particleStore& store(inSettings->particles);
+	const std::vector<unsigned int>& visible(inSettings->onScreen.visible);
+	if(inSettings->dSmokeBlend == SMOKEBLEND_WEIGHTED){
+		for(unsigned int n=0; n<visible.size(); n++){
+			if(store.type[visible[n]] == SMOKE)
+				particle(inSettings->particles, visible[n]).draw(*this, inSettings);
+		}
+	}
+	else{
+		const std::vector<unsigned int>& smokeOrder(inSettings->smokeOrder.order);
+		for(unsigned int n=0; n<smokeOrder.size(); n++)
+			particle(inSettings->particles, smokeOrder[n]).draw(*this, inSettings);
+	}
+	for(unsigned int n=0; n<visible.size(); n++){
+		if(store.type[visible[n]] != SMOKE)
+			particle(inSettings->particles, visible[n]).draw(*this, inSettings);
+	}
+}
+
+
+void renderQueue::setBlend(unsigned int src, unsigned int dst){
+	if(src == blendSrc && dst == blendDst)
+		return;
+	glBlendFunc(src, dst);
+	blendSrc = src;
+	blendDst = dst;
+	++stateChanges;
+}
+
+
+void renderQueue::bindTexture(unsigned int tex){
+	if(tex == texture)
+		return;
+	glBindTexture(GL_TEXTURE_2D, tex);
+	texture = tex;
+	++stateChanges;
+}
+
+
+void renderQueue::drawSmoke(SkyrocketSaverSettings *inSettings){
+	// whatever drew last (the world) could have left anything set
+	blendSrc = blendDst = texture = ~0u;
+	if(smoke.empty())
+		return;
+
+	bindTexture(spriteAtlas());
+	if(inSettings->dSmokeBlend == SMOKEBLEND_WEIGHTED){
+		beginOit(stateChanges);
+		drawBillboards(smoke, 1, stateChanges, inSettings);
+		endOit(stateChanges);
+		// the composite leaves its own blend function and no texture
+		blendSrc = blendDst = texture = ~0u;
+		drawCalls += 2;
+	}
+	else{
+		setBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		drawBillboards(smoke, 0, stateChanges, inSettings);
+		++drawCalls;
+	}
+}
+
+
+void renderQueue::draw(SkyrocketSaverSettings *inSettings){
+	stateChanges = drawCalls = 0;
+	glEnable(GL_BLEND);
+	glEnable(GL_TEXTURE_2D);
+
+	drawSmoke(inSettings);
+
+	setBlend(GL_SRC_ALPHA, GL_ONE);
+	if(!shockwaves.empty()){
+		bindTexture(inSettings->theWorld->cloudtex);
+		glDisable(GL_CULL_FACE);
+		beginShockwaves(stateChanges);
+		for(unsigned int i=0; i<shockwaves.size(); ++i){
+			const shockwaveRing& ring(shockwaves[i]);
+			glPushMatrix();
+				glTranslatef(ring.xyz[0], ring.xyz[1], ring.xyz[2]);
+				glScalef(ring.size, ring.size, ring.size);
+				drawShockwave(ring.life, float(sqrt(ring.size)) * 0.05f);
+			glPopMatrix();
+		}
+		endShockwaves(stateChanges);
+		glEnable(GL_CULL_FACE);
+		drawCalls += shockwaves.size();
+	}
+
+	if(!glow.empty()){
+		bindTexture(spriteAtlas());
+		drawBillboards(glow, 0, stateChanges, inSettings);
+		++drawCalls;
+		if(inSettings->dFlare && inSettings->dFlareStyle == FLARESTYLE_SCREEN){
+			beginLensFlare(stateChanges);
+			drawBillboards(glow, 0, stateChanges, inSettings);
+			endLensFlare(float(inSettings->dFlare) * 0.01f, stateChanges);
+			// the composite leaves its own blend function and no texture
+			blendSrc = blendDst = texture = ~0u;
+			drawCalls += 3;
+		}
+	}
+
+	if(!flares.empty()){
+		bindTexture(spriteAtlas());
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		glOrtho(0.0, inSettings->aspectRatio, 0.0, 1.0, -1.0, 1.0);
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		drawScreenSprites(flares);
+		glPopMatrix();
+		glMatrixMode(GL_PROJECTION);
+		glPopMatrix();
+		glMatrixMode(GL_MODELVIEW);
+		++drawCalls;
+	}
+}
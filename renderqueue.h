@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+
+
+#include <vector>
+#include "billboard.h"
+
+struct SkyrocketSaverSettings;
+
+
+// A shockwave's ring (see drawShockwave())
+struct shockwaveRing{
+	float xyz[3];
+	float size;
+	float life;
+};
+
+
+// Everything drawn in front of the world in one frame.  particle::draw() and
+// flare() add to a queue instead of drawing, and draw() then goes through it
+// one pass at a time, so each blend function and texture is set once per frame
+// rather than once per particle:
+//   smoke           blended by alpha in the order given, or weighted (oit.h)
+//   shockwaves      additive, cloud texture
+//   glow            additive, sprite atlas, and again into the lens flare
+//                   post process with FLARESTYLE_SCREEN (lensflare.h)
+//   flares          additive, sprite atlas, on the screen
+class renderQueue{
+public:
+	std::vector<billboard> smoke;
+	std::vector<shockwaveRing> shockwaves;
+	std::vector<billboard> glow;  // everything else, including each particle's white core
+	std::vector<screenSprite> flares;
+	// what the last draw() cost
+	unsigned int stateChanges;  // blend functions, textures, shader programs, and render targets set
+	unsigned int drawCalls;
+
+	renderQueue() : stateChanges(0), drawCalls(0) {}
+	// Empty the queue for a new frame
+	void clear();
+	// Add every particle in view (onScreen) with particle::draw().  Smoke goes
+	// first, back to front (smokeOrder, sorted by the caller) or in any order for
+	// weighted blending, as dSmokeBlend says, so it composites properly.
+	// Everything else is additive, so it can go in any order on top.
+	void addParticles(SkyrocketSaverSettings *inSettings);
+	void draw(SkyrocketSaverSettings *inSettings);
+	// Just the smoke pass, which draw() starts with.  Adds to stateChanges
+	// and drawCalls.  Blending and texturing must be on.
+	void drawSmoke(SkyrocketSaverSettings *inSettings);
+
+private:
+	unsigned int blendSrc, blendDst;  // what OpenGL has now, or ~0 if unknown
+	unsigned int texture;
+
+	void setBlend(unsigned int src, unsigned int dst);
+	void bindTexture(unsigned int tex);
+};
+
+
+
+#endif  // RENDERQUEUE_H
@@ -35,6 +35,7 @@
 #include "rsMatrix.h"
 #include "rsQuat.h"
 #include "rsTrigonometry.h"
+#include "rsRandom.h"
 #ifdef __SSE__
 #include <xmmintrin.h>
 #endif
@@ -50,14 +51,15 @@
 
 
 // Useful random number functions
-// Don't forget to initialize with srand()
+// These draw from rsCurrentRandom (see rsRandom.h), so seed that
+// instead of calling srand()
 inline int rsRandi(int x){
-	return rand() % x;
+	return rsCurrentRandom->randi(x);
 }
 
 
 inline float rsRandf(float x){
-	return x * (float(rand()) / float(RAND_MAX));
+	return rsCurrentRandom->randf(x);
 }
 
 
@@ -305,6 +305,28 @@ void rsMatrix::makeRotate(rsQuat &q){
 }
 
 
+void rsMatrix::makePerspective(float fovy, float aspect, float zNear, float zFar){
+	const float f(1.0f / tanf(fovy * 0.5f));
+	const float depth(zNear - zFar);
+	m[0] = f / aspect;
+	m[1] = 0.0f;
+	m[2] = 0.0f;
+	m[3] = 0.0f;
+	m[4] = 0.0f;
+	m[5] = f;
+	m[6] = 0.0f;
+	m[7] = 0.0f;
+	m[8] = 0.0f;
+	m[9] = 0.0f;
+	m[10] = (zFar + zNear) / depth;
+	m[11] = -1.0f;
+	m[12] = 0.0f;
+	m[13] = 0.0f;
+	m[14] = (2.0f * zFar * zNear) / depth;
+	m[15] = 0.0f;
+}
+
+
 void rsMatrix::translate(float x, float y, float z){
 	rsMatrix mat;
 	mat.makeTranslate(x, y, z);
@@ -60,6 +60,8 @@ public:
 	void makeRotate(float a, float x, float y, float z);  // normalized angle, axis
 	void makeRotate(float a, const rsVec &v);  // normalized angle, axis
 	void makeRotate(rsQuat &q);
+	// Same as gluPerspective(), but fovy is in radians
+	void makePerspective(float fovy, float aspect, float zNear, float zFar);
 	void translate(float x, float y, float z);
 	void translate(float* p);
 	void translate(const rsVec &vec);
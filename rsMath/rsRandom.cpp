@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of rsMath.
+ *
+ * rsMath is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * rsMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+//#include <rsMath/rsMath.h>
+#include "rsMath.h"
+
+
+
+rsRandom rsDefaultRandom;
+thread_local rsRandom* rsCurrentRandom(&rsDefaultRandom);
+
+
+
+rsRandom::rsRandom(){
+	seed(0);
+}
+
+rsRandom::rsRandom(uint64_t seed){
+	this->seed(seed);
+}
+
+void rsRandom::seed(uint64_t seed){
+	// Spread the seed over all 128 bits of state with splitmix64 so that
+	// similar seeds (0, 1, 2...) still give unrelated sequences
+	for(int i=0; i<4; i+=2){
+		seed += 0x9e3779b97f4a7c15ULL;
+		uint64_t z(seed);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		z ^= z >> 31;
+		s[i] = uint32_t(z);
+		s[i + 1] = uint32_t(z >> 32);
+	}
+	// all-zero state would only ever produce zeros
+	if(!(s[0] | s[1] | s[2] | s[3]))
+		s[0] = 1;
+}
+
+void rsRandom::fillf(float* out, unsigned int count, float x){
+	// Work on a local copy of the state so the compiler can keep it in registers
+	rsRandom r(*this);
+	const float scale(x * (1.0f / 16777216.0f));
+	for(unsigned int i=0; i<count; ++i)
+		out[i] = float(r.next() >> 8) * scale;
+	*this = r;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of rsMath.
+ *
+ * rsMath is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * rsMath is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+
+#ifndef RSRANDOM_H
+#define RSRANDOM_H
+
+
+
+#include <stdint.h>
+
+
+
+// Small, fast pseudorandom number generator (xoshiro128+) with its own state.
+// Each thread that needs random numbers should have its own rsRandom.  The
+// same seed always produces the same sequence on every platform.
+class rsRandom{
+public:
+	rsRandom();
+	rsRandom(uint64_t seed);
+	void seed(uint64_t seed);
+
+	// 32 random bits
+	uint32_t next(){
+		const uint32_t result(s[0] + s[3]);
+		const uint32_t t(s[1] << 9);
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = (s[3] << 11) | (s[3] >> 21);
+		return result;
+	}
+	// integer in [0, x)
+	int randi(int x)
+		{return(int((uint64_t(next()) * uint32_t(x)) >> 32));}
+	// float in [0, x)
+	float randf(float x)
+		{return(x * (float(next() >> 8) * (1.0f / 16777216.0f)));}
+	// Fill out[0] through out[count-1] with floats in [0, x)
+	void fillf(float* out, unsigned int count, float x);
+
+private:
+	uint32_t s[4];
+};
+
+
+// Stream used by rsRandi() and rsRandf() on the calling thread.  Every thread
+// starts out sharing rsDefaultRandom, which is only safe for one thread, so
+// threads that make random numbers should point this at their own stream.
+extern rsRandom rsDefaultRandom;
+extern thread_local rsRandom* rsCurrentRandom;
+
+
+
+#endif
@@ -25,8 +25,10 @@
 #include <Skyrocket/world.h>
 #include <math.h>*/
 #include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <stddef.h>
 #include "shockwave.h"
-#include "world.h"
+#include "glshader.h"
 #include <math.h>
 
 
@@ -36,6 +38,63 @@
 #define WAVESTEPS 40
 float shockwavegeom[7][WAVESTEPS+1][3];
 
+// The bottom and top of a shockwave share one mesh:  vertex (ring, step) of
+// the bottom is number ring * (WAVESTEPS+1) + step, and the top follows.
+#define WAVEVERTS (2 * 7 * (WAVESTEPS+1))
+#define WAVEINDICES (2 * 6 * WAVESTEPS * 6)
+// Rings fade out toward the inside
+static const float ringAlpha[7] = {1.0f, 0.9f, 0.8f, 0.7f, 0.5f, 0.3f, 0.0f};
+
+struct waveVertex{
+	float xyz[3];
+	float uv[2];
+	float alpha;  // ringAlpha, times temperature squared
+	float warm;  // 1 where green is a little higher (the top, past the outside ring)
+};
+static waveVertex waveVerts[WAVEVERTS];
+
+// Attribute location of waveVertex's alpha and warm in shockwaveProgram
+#define ATTRIB_RING 3
+
+// Color comes from temperature just as it used to per vertex.  texmove slides
+// the texture inward.
+static const char* shockwaveVertexShader =
+	"#version 120\n"
+	"attribute vec2 ring;  // alpha, warm\n"
+	"uniform float temperature;\n"
+	"uniform float texmove;\n"
+	"void main(){\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+	"	float green = mix((temperature + 1.0) * 0.5, (temperature + 2.0) * 0.333333, ring.y);\n"
+	"	gl_FrontColor = vec4(1.0, green, temperature, temperature * temperature * ring.x);\n"
+	"	gl_TexCoord[0] = vec4(gl_MultiTexCoord0.s, gl_MultiTexCoord0.t - texmove, 0.0, 1.0);\n"
+	"}\n";
+static const char* shockwaveFragmentShader =
+	"#version 120\n"
+	"uniform sampler2D cloudTex;\n"
+	"void main(){\n"
+	"	gl_FragColor = gl_Color * texture2D(cloudTex, gl_TexCoord[0].st);\n"
+	"}\n";
+
+static GLuint shockwaveProgram = 0;  // 0 if colors are worked out on the CPU
+static GLint temperatureLocation, texmoveLocation;
+static GLuint waveBuffer = 0;
+static GLuint waveIndexBuffer = 0;
+
+
+
+static void initShockwaveProgram(){
+	const shaderAttrib attribs[1] = {{ATTRIB_RING, "ring"}};
+	shockwaveProgram = linkShaderProgram(shockwaveVertexShader, shockwaveFragmentShader, attribs, 1);
+	if(!shockwaveProgram)
+		return;
+	glUseProgram(shockwaveProgram);
+	glUniform1i(glGetUniformLocation(shockwaveProgram, "cloudTex"), 0);
+	temperatureLocation = glGetUniformLocation(shockwaveProgram, "temperature");
+	texmoveLocation = glGetUniformLocation(shockwaveProgram, "texmove");
+	glUseProgram(0);
+}
+
 
 
 void initShockwave(){
@@ -73,75 +132,123 @@ void initShockwave(){
 			shockwavegeom[j][i][2] = sh * shockwavegeom[j][0][0];
 		}
 	}
+
+	// bottom, then top, with y flipped for the bottom
+	for(int half=0; half<2; half++){
+		for(i=0; i<=6; i++){
+			for(j=0; j<=WAVESTEPS; j++){
+				waveVertex& v(waveVerts[(half * 7 + i) * (WAVESTEPS+1) + j]);
+				v.xyz[0] = shockwavegeom[i][j][0];
+				v.xyz[1] = half ? shockwavegeom[i][j][1] : -shockwavegeom[i][j][1];
+				v.xyz[2] = shockwavegeom[i][j][2];
+				v.uv[0] = (float(j) / float(WAVESTEPS)) * 10.0f;
+				v.uv[1] = float(i) * 0.07f;
+				v.alpha = ringAlpha[i];
+				v.warm = (half && i > 0) ? 1.0f : 0.0f;
+			}
+		}
+	}
+	// Each band between two rings used to be a triangle strip.  These are the
+	// same triangles, facing the same way.
+	unsigned short indices[WAVEINDICES];
+	unsigned short* index(indices);
+	for(int half=0; half<2; half++){
+		for(i=0; i<6; i++){
+			// the strip went from first to second at each step
+			const unsigned short thisRing((half * 7 + i) * (WAVESTEPS+1));
+			const unsigned short nextRing(thisRing + (WAVESTEPS+1));
+			const unsigned short first(half ? thisRing : nextRing);
+			const unsigned short second(half ? nextRing : thisRing);
+			for(j=0; j<WAVESTEPS; j++){
+				index[0] = first + j;
+				index[1] = second + j;
+				index[2] = first + j + 1;
+				index[3] = first + j + 1;
+				index[4] = second + j;
+				index[5] = second + j + 1;
+				index += 6;
+			}
+		}
+	}
+	glGenBuffers(1, &waveBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, waveBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(waveVerts), waveVerts, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glGenBuffers(1, &waveIndexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, waveIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	initShockwaveProgram();
+}
+
+void beginShockwaves(unsigned int &stateChanges){
+	glBindBuffer(GL_ARRAY_BUFFER, waveBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(waveVertex), (void*)offsetof(waveVertex, xyz));
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(waveVertex), (void*)offsetof(waveVertex, uv));
+	if(shockwaveProgram){
+		glUseProgram(shockwaveProgram);
+		++stateChanges;
+		glEnableVertexAttribArray(ATTRIB_RING);
+		glVertexAttribPointer(ATTRIB_RING, 2, GL_FLOAT, GL_FALSE, sizeof(waveVertex), (void*)offsetof(waveVertex, alpha));
+	}
+	else
+		glEnableClientState(GL_COLOR_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, waveIndexBuffer);
 }
 
-// temp influences color intensity (0.0 - 1.0)
-// texmove is amount to advance the texture coordinates
-void drawShockwave(float temperature, float texmove, SkyrocketSaverSettings *inSettings){
-	static int i, j;
-	float colors[7][4];
-	static float u, v1, v2;
-	float temp;
-
-	// setup diminishing alpha values in color array
-	temp = temperature * temperature;
-	colors[0][3] = temp;
-	colors[1][3] = temp * 0.9f;
-	colors[2][3] = temp * 0.8f;
-	colors[3][3] = temp * 0.7f;
-	colors[4][3] = temp * 0.5f;
-	colors[5][3] = temp * 0.3f;
-	colors[6][3] = 0.0f;
-	// setup rgb values in color array
-	for(i=0; i<=5; i++){
+
+void drawShockwave(float temperature, float texmove){
+	if(shockwaveProgram){
+		glUniform1f(temperatureLocation, temperature);
+		glUniform1f(texmoveLocation, texmove);
+		glDrawElements(GL_TRIANGLES, WAVEINDICES, GL_UNSIGNED_SHORT, NULL);
+		return;
+	}
+
+	// same colors as the shader, worked out here
+	float colors[WAVEVERTS][4];
+	const float temp(temperature * temperature);
+	for(int i=0; i<WAVEVERTS; i++){
 		colors[i][0] = 1.0f;
-		colors[i][1] = (temperature + 1.0f) * 0.5f;
+		colors[i][1] = waveVerts[i].warm ? (temperature + 2.0f) * 0.333333f : (temperature + 1.0f) * 0.5f;
 		colors[i][2] = temperature;
+		colors[i][3] = temp * waveVerts[i].alpha;
 	}
+	glColorPointer(4, GL_FLOAT, 0, colors);
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glTranslatef(0.0f, -texmove, 0.0f);
+	glDrawElements(GL_TRIANGLES, WAVEINDICES, GL_UNSIGNED_SHORT, NULL);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+}
 
-	glDisable(GL_CULL_FACE);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-	glEnable(GL_BLEND);
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, inSettings->theWorld->cloudtex);
-
-	// draw bottom of shockwave
-	for(i=0; i<6; i++){
-		v1 = float(i+1) * 0.07f - texmove;
-		v2 = float(i) * 0.07f - texmove;
-		glBegin(GL_TRIANGLE_STRIP);
-		for(j=0; j<=WAVESTEPS; j++){
-			u = (float(j) / float(WAVESTEPS)) * 10.0f;
-			glColor4fv(colors[i+1]);
-			glTexCoord2f(u, v1);
-			glVertex3f(shockwavegeom[i+1][j][0], -shockwavegeom[i+1][j][1], shockwavegeom[i+1][j][2]);
-			glColor4fv(colors[i]);
-			glTexCoord2f(u, v2);
-			glVertex3f(shockwavegeom[i][j][0], -shockwavegeom[i][j][1], shockwavegeom[i][j][2]);
-		}
-		glEnd();
-	}
 
-	// keep colors a little warmer on top (more green)
-	for(i=1; i<=6; i++)
-		colors[i][1] = (temperature + 2.0f) * 0.333333f;
-	
-	// draw top of shockwave
-	for(i=0; i<6; i++){
-		v1 = float(i) * 0.07f - texmove;
-		v2 = float(i+1) * 0.07f - texmove;
-		glBegin(GL_TRIANGLE_STRIP);
-		for(j=0; j<=WAVESTEPS; j++){
-			u = (float(j) / float(WAVESTEPS)) * 10.0f;
-			glColor4fv(colors[i]);
-			glTexCoord2f(u, v1);
-			glVertex3f(shockwavegeom[i][j][0], shockwavegeom[i][j][1], shockwavegeom[i][j][2]);
-			glColor4fv(colors[i+1]);
-			glTexCoord2f(u, v2);
-			glVertex3f(shockwavegeom[i+1][j][0], shockwavegeom[i+1][j][1], shockwavegeom[i+1][j][2]);
-		}
-		glEnd();
+void endShockwaves(unsigned int &stateChanges){
+	if(shockwaveProgram){
+		glDisableVertexAttribArray(ATTRIB_RING);
+		glUseProgram(0);
+		++stateChanges;
 	}
+	else
+		glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
 
-	glEnable(GL_CULL_FACE);
+void cleanupShockwave(){
+	if(shockwaveProgram)
+		glDeleteProgram(shockwaveProgram);
+	if(waveBuffer)
+		glDeleteBuffers(1, &waveBuffer);
+	if(waveIndexBuffer)
+		glDeleteBuffers(1, &waveIndexBuffer);
+	shockwaveProgram = 0;
+	waveBuffer = waveIndexBuffer = 0;
 }
@@ -22,13 +22,23 @@
 #ifndef SHOCKWAVE_H
 #define SHOCKWAVE_H
 
-struct SkyrocketSaverSettings;
 
+
+// Builds the shockwave mesh in a vertex buffer, and a shader to color it
+// if OpenGL has shaders
 void initShockwave();
 
+// Draw shockwaves between beginShockwaves() and endShockwaves(), with
+// additive blending, the world's cloud texture bound, and face culling off.
+// renderQueue sets that up once for all the shockwaves.  Both add the shader
+// programs they set to stateChanges.
+void beginShockwaves(unsigned int &stateChanges);
+// One draw call with the modelview matrix placing and scaling the shockwave.
 // temp influences color intensity (0.0 - 1.0)
 // texmove is amount to advance the texture coordinates
-void drawShockwave(float temperature, float texmove, SkyrocketSaverSettings *settings);
+void drawShockwave(float temperature, float texmove);
+void endShockwaves(unsigned int &stateChanges);
+void cleanupShockwave();
 
 
 
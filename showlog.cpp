@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "showlog.h"
+#include "Skyrocket.h"
+#include "workerpool.h"
+#include <string.h>
+
+
+// Number of settings in the log header
+#define SHOWLOGPARAMS 23
+
+
+static void putU32(unsigned int value, FILE* file){
+	unsigned char bytes[4];
+	bytes[0] = value & 0xff;
+	bytes[1] = (value >> 8) & 0xff;
+	bytes[2] = (value >> 16) & 0xff;
+	bytes[3] = (value >> 24) & 0xff;
+	fwrite(bytes, 1, 4, file);
+}
+
+
+static bool getU32(unsigned int &value, FILE* file){
+	unsigned char bytes[4];
+	if(fread(bytes, 1, 4, file) != 4)
+		return false;
+	value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)(bytes[3]) << 24);
+	return true;
+}
+
+
+static void putFloat(float value, FILE* file){
+	unsigned int bits;
+	memcpy(&bits, &value, 4);
+	putU32(bits, file);
+}
+
+
+static bool getFloat(float &value, FILE* file){
+	unsigned int bits;
+	if(!getU32(bits, file))
+		return false;
+	memcpy(&value, &bits, 4);
+	return true;
+}
+
+
+// Everything in the settings that changes how a show plays out (and the rest of
+// the dialog box settings, so a replay can be drawn the same way).  threads is
+// the number of update threads actually used, because that decides which random
+// stream each particle gets.
+static void getParams(int* params, int width, int height, int threads, SkyrocketSaverSettings *inSettings){
+	params[0] = width;
+	params[1] = height;
+	params[2] = threads;
+	params[3] = inSettings->dMaxrockets;
+	params[4] = inSettings->dSmoke;
+	params[5] = inSettings->dExplosionsmoke;
+	params[6] = inSettings->dWind;
+	params[7] = inSettings->dAmbient;
+	params[8] = inSettings->dStardensity;
+	params[9] = inSettings->dFlare;
+	params[10] = inSettings->dMoonglow;
+	params[11] = inSettings->dSound;
+	params[12] = inSettings->kCamera;
+	params[13] = inSettings->dMoon;
+	params[14] = inSettings->dClouds;
+	params[15] = inSettings->dEarth;
+	params[16] = inSettings->dIllumination;
+	params[17] = inSettings->dFrameRateLimit;
+	params[18] = inSettings->kSlowMotion ? 1 : 0;
+	params[19] = inSettings->dMaxParticles;
+	params[20] = inSettings->dSimd;
+	params[21] = inSettings->dAutoLaunch;
+	params[22] = inSettings->dSimRate;
+}
+
+
+static void setParams(const int* params, int &width, int &height, SkyrocketSaverSettings *inSettings){
+	width = params[0];
+	height = params[1];
+	inSettings->dThreads = params[2];
+	inSettings->dMaxrockets = params[3];
+	inSettings->dSmoke = params[4];
+	inSettings->dExplosionsmoke = params[5];
+	inSettings->dWind = params[6];
+	inSettings->dAmbient = params[7];
+	inSettings->dStardensity = params[8];
+	inSettings->dFlare = params[9];
+	inSettings->dMoonglow = params[10];
+	inSettings->dSound = params[11];
+	inSettings->kCamera = params[12];
+	inSettings->dMoon = params[13];
+	inSettings->dClouds = params[14];
+	inSettings->dEarth = params[15];
+	inSettings->dIllumination = params[16];
+	inSettings->dFrameRateLimit = params[17];
+	inSettings->kSlowMotion = params[18] != 0;
+	inSettings->dMaxParticles = params[19];
+	inSettings->dSimd = params[20];
+	inSettings->dAutoLaunch = params[21];
+	inSettings->dSimRate = params[22];
+}
+
+
+bool startRecording(const char* path, SkyrocketSaverSettings *inSettings){
+	stopShowLog(inSettings);
+	FILE* file = fopen(path, "wb");
+	if(!file)
+		return false;
+
+	int params[SHOWLOGPARAMS];
+	getParams(params, inSettings->xsize, inSettings->ysize, inSettings->workers->size(), inSettings);
+	fwrite("SKYR", 1, 4, file);
+	putU32(SHOWLOG_VERSION, file);
+	putU32(inSettings->seed, file);
+	for(unsigned int i=0; i<SHOWLOGPARAMS; ++i)
+		putU32((unsigned int)(params[i]), file);
+
+	inSettings->log = new showLog(file, false);
+	return true;
+}
+
+
+bool startReplay(const char* path, int &width, int &height, SkyrocketSaverSettings *inSettings){
+	stopShowLog(inSettings);
+	FILE* file = fopen(path, "rb");
+	if(!file)
+		return false;
+
+	char magic[4];
+	unsigned int version, seed, value;
+	int params[SHOWLOGPARAMS];
+	bool ok(fread(magic, 1, 4, file) == 4 && !memcmp(magic, "SKYR", 4)
+		&& getU32(version, file) && version == SHOWLOG_VERSION
+		&& getU32(seed, file));
+	for(unsigned int i=0; ok && i<SHOWLOGPARAMS; ++i){
+		ok = getU32(value, file);
+		params[i] = int(value);
+	}
+	if(!ok){
+		fclose(file);
+		return false;
+	}
+
+	setParams(params, width, height, inSettings);
+	inSettings->dSeed = seed;
+	inSettings->log = new showLog(file, true);
+	return true;
+}
+
+
+int replayFrame(SkyrocketSaverSettings *inSettings){
+	showLog* log = inSettings->log;
+	if(!log || !log->replaying)
+		return 0;
+
+	int type;
+	while((type = fgetc(log->file)) != EOF){
+		switch(type){
+		case SHOWLOG_FRAME:
+			if(!getFloat(log->lastFrameTime, log->file))
+				return 0;
+			// fall through
+		case SHOWLOG_REPEAT:
+			inSettings->frameTime = log->lastFrameTime;
+			++log->frames;
+			return 1;
+		case SHOWLOG_INPUT:{
+			unsigned int wpm, lpm;
+			const int msg(fgetc(log->file));
+			if(msg == EOF || !getU32(wpm, log->file) || !getU32(lpm, log->file))
+				return 0;
+			ScreenSaverProc((unsigned int)msg, wpm, lpm, inSettings);
+			break;
+		}
+		case SHOWLOG_EXPLOSION:{
+			unsigned int explosion;
+			if(!getU32(explosion, log->file))
+				return 0;
+			requestExplosion(int(explosion), inSettings);
+			break;
+		}
+		default:  // not a show log after all
+			return 0;
+		}
+	}
+	return 0;
+}
+
+
+void stopShowLog(SkyrocketSaverSettings *inSettings){
+	if(!inSettings->log)
+		return;
+	fclose(inSettings->log->file);
+	delete inSettings->log;
+	inSettings->log = NULL;
+}
+
+
+void logFrame(SkyrocketSaverSettings *inSettings){
+	showLog* log = inSettings->log;
+	if(!log || log->replaying)
+		return;
+	if(inSettings->frameTime == log->lastFrameTime)
+		fputc(SHOWLOG_REPEAT, log->file);
+	else{
+		fputc(SHOWLOG_FRAME, log->file);
+		putFloat(inSettings->frameTime, log->file);
+		log->lastFrameTime = inSettings->frameTime;
+	}
+	++log->frames;
+}
+
+
+void logInput(unsigned int msg, unsigned int wpm, unsigned long lpm, SkyrocketSaverSettings *inSettings){
+	showLog* log = inSettings->log;
+	if(!log || log->replaying)
+		return;
+	fputc(SHOWLOG_INPUT, log->file);
+	fputc(msg & 0xff, log->file);
+	putU32(wpm, log->file);
+	putU32((unsigned int)lpm, log->file);
+}
+
+
+void logExplosion(int explosion, SkyrocketSaverSettings *inSettings){
+	showLog* log = inSettings->log;
+	if(!log || log->replaying)
+		return;
+	fputc(SHOWLOG_EXPLOSION, log->file);
+	putU32((unsigned int)explosion, log->file);
+}
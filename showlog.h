@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef SHOWLOG_H
+#define SHOWLOG_H
+
+
+
+#include <stdio.h>
+
+struct SkyrocketSaverSettings;
+
+
+// A show log holds everything needed to play a show again exactly:  the seed,
+// the settings, and then every frameTime and input in the order they happened.
+// Replaying a log on the same build reproduces the particles bit for bit, as long
+// as the CPU picks the same kinematics kernel (see chooseKinematics()).
+//
+// File layout, all numbers little-endian:
+//   "SKYR", version, seed, then the settings as SHOWLOGPARAMS ints (showlog.cpp)
+//   then records, each a type byte followed by:
+//     SHOWLOG_FRAME:  frameTime (32-bit float)
+//     SHOWLOG_REPEAT:  nothing; a frame with the same frameTime as the last one
+//     SHOWLOG_INPUT:  ScreenSaverProc() msg (8 bits), wpm (32 bits), lpm (32 bits)
+//     SHOWLOG_EXPLOSION:  requestExplosion() type (32 bits)
+#define SHOWLOG_VERSION 2
+#define SHOWLOG_FRAME 1
+#define SHOWLOG_REPEAT 2
+#define SHOWLOG_INPUT 3
+#define SHOWLOG_EXPLOSION 4
+
+
+class showLog{
+public:
+	FILE* file;
+	bool replaying;
+	float lastFrameTime;  // for SHOWLOG_REPEAT
+	unsigned int frames;  // frames recorded or replayed so far
+
+	showLog(FILE* f, bool replay) : file(f), replaying(replay), lastFrameTime(-1.0f), frames(0) {}
+};
+
+
+// Start logging the show in inSettings to a file.  Call right after initSim()
+// (or initSaver()).  Returns false if the file can't be written.
+bool startRecording(const char* path, SkyrocketSaverSettings *inSettings);
+// Open a log and copy its seed and settings into inSettings.  Then call initSim()
+// with the returned width and height, and replayFrame() before every updateSim().
+// Returns false if the file can't be read or isn't a show log.
+bool startReplay(const char* path, int &width, int &height, SkyrocketSaverSettings *inSettings);
+// Apply the next frame's inputs and set frameTime.  Returns 0 once the log is
+// used up.
+int replayFrame(SkyrocketSaverSettings *inSettings);
+// Close the log, if any.  cleanupSim() calls this.
+void stopShowLog(SkyrocketSaverSettings *inSettings);
+
+// The simulation calls these to record what it is given
+void logFrame(SkyrocketSaverSettings *inSettings);
+void logInput(unsigned int msg, unsigned int wpm, unsigned long lpm, SkyrocketSaverSettings *inSettings);
+void logExplosion(int explosion, SkyrocketSaverSettings *inSettings);
+
+
+
+#endif
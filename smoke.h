@@ -27,8 +27,6 @@
 /*#include <windows.h>
 #include <gl/gl.h>
 #include <gl/glu.h>*/
-#include <OpenGL/gl.h>
-#include <OpenGL/glu.h>
 //#include "Skyrocket.h"
 
 
@@ -47,7 +45,7 @@ extern int whichSmoke[WHICHSMOKES];  // table to indicate which particles produc
 
 typedef struct SkyrocketSaverSettings;
 
-// Initialize smoke texture objects and display lists
+// Copy the smoke textures into the sprite atlas
 void initSmoke(SkyrocketSaverSettings *inSettings);
 
 
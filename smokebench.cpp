@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+// Skyrocket smoke drawing benchmark
+//
+// Smoke is drawn one of two ways (SMOKEBLEND_ in Skyrocket.h):  sorted back to
+// front and blended by alpha, or in any order with weighted blended
+// transparency (oit.h), which saves the sort but draws into two floating point
+// targets and then composites them.  This runs one show and, each frame, queues
+// and draws the smoke in view both ways with the screensaver's own renderQueue
+// into an offscreen framebuffer, timing each with GL_TIME_ELAPSED queries
+// where OpenGL has them, so that both sides of the trade are measured on
+// exactly the same smoke.  Prints JSON.
+//
+// usage:  skyrocket_smokebench [-seconds s] [-frametime t] [-seed n] [-width w] [-height h]
+//                              [-rockets n] [-smoke s]
+// The show is the regular one with up to -rockets rockets at a time, and smoke
+// that lasts up to -smoke seconds.  "sort" is the CPU time spent ordering smoke
+// (see depthSort), "gpu" is what OpenGL measured for each way of drawing, and
+// "wall" is the same drawing timed on the CPU through glFinish().  Software
+// renderers such as llvmpipe draw later than the query sees, so only "wall"
+// means anything there.  An OpenGL context is made without a window through
+// EGL, using Mesa's surfaceless platform when it is there.
+
+
+#include "Skyrocket.h"
+#include "billboard.h"
+#include "oit.h"
+#include "renderqueue.h"
+#include "smoke.h"
+#include <OpenGL/gl.h>
+#include <OpenGL/glext.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+
+struct benchOptions{
+	float seconds;
+	float frameTime;
+	unsigned int seed;
+	int width, height;
+	int rockets;
+	int smoke;
+};
+
+
+// What one way of drawing smoke cost over the whole show
+struct drawCost{
+	double gpu;
+	double wall;
+	unsigned long long billboards;
+	unsigned long long stateChanges;
+};
+
+
+static double benchClock(){
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Make an OpenGL context with no window current.  Returns 0 if EGL can't.
+static int makeContext(){
+	EGLDisplay display(EGL_NO_DISPLAY);
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay(
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if(getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+	if(display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if(display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+		return 0;
+
+	// Nothing is drawn to a surface, so any config will do
+	const EGLint attribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE};
+	EGLConfig config;
+	EGLint numConfigs(0);
+	if(!eglChooseConfig(display, attribs, &config, 1, &numConfigs) || numConfigs < 1)
+		return 0;
+	EGLContext context(eglCreateContext(display, config, EGL_NO_CONTEXT, NULL));
+	if(context == EGL_NO_CONTEXT)
+		return 0;
+	return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) ? 1 : 0;
+}
+
+
+// Queue the particles in view the way draw() does with smokeBlend, draw the
+// smoke pass, and add what it cost
+static void timeSmoke(renderQueue &queue, int smokeBlend, unsigned int query,
+	drawCost &cost, SkyrocketSaverSettings *inSettings){
+	inSettings->dSmokeBlend = smokeBlend;
+	queue.clear();
+	queue.addParticles(inSettings);
+	queue.stateChanges = queue.drawCalls = 0;
+
+	glClear(GL_COLOR_BUFFER_BIT);
+	glFinish();
+	const double start(benchClock());
+	if(query)
+		glBeginQuery(GL_TIME_ELAPSED, query);
+	queue.drawSmoke(inSettings);
+	if(query)
+		glEndQuery(GL_TIME_ELAPSED);
+	glFinish();
+	cost.wall += benchClock() - start;
+	if(query){
+		GLuint64 nanoseconds(0);
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+		cost.gpu += double(nanoseconds) * 1.0e-9;
+	}
+	cost.billboards += queue.smoke.size();
+	cost.stateChanges += queue.stateChanges;
+}
+
+
+static void printCost(const char* name, const drawCost &cost, double sort, bool last){
+	printf("    \"%s\": {\n", name);
+	printf("      \"billboards\": %llu,\n", cost.billboards);
+	printf("      \"stateChanges\": %llu,\n", cost.stateChanges);
+	printf("      \"sort\": %.6f,\n", sort);
+	printf("      \"gpu\": %.6f,\n", cost.gpu);
+	printf("      \"wall\": %.6f\n", cost.wall);
+	printf("    }%s\n", last ? "" : ",");
+}
+
+
+static void usage(){
+	fprintf(stderr, "usage: skyrocket_smokebench [-seconds s] [-frametime t] [-seed n] [-width w] [-height h]\n"
+		"                            [-rockets n] [-smoke s]\n");
+	exit(1);
+}
+
+
+int main(int argc, char** argv){
+	benchOptions options;
+	options.seconds = 10.0f;
+	options.frameTime = 1.0f / 60.0f;
+	options.seed = 1;
+	options.width = 1280;
+	options.height = 720;
+	options.rockets = 30;
+	options.smoke = 20;
+
+	for(int i=1; i<argc; ++i){
+		if(argv[i][0] != '-' || i + 1 >= argc)
+			usage();
+		const char* value(argv[++i]);
+		if(!strcmp(argv[i - 1], "-seconds"))
+			options.seconds = float(atof(value));
+		else if(!strcmp(argv[i - 1], "-frametime"))
+			options.frameTime = float(atof(value));
+		else if(!strcmp(argv[i - 1], "-seed"))
+			options.seed = (unsigned int)strtoul(value, NULL, 10);
+		else if(!strcmp(argv[i - 1], "-width"))
+			options.width = atoi(value);
+		else if(!strcmp(argv[i - 1], "-height"))
+			options.height = atoi(value);
+		else if(!strcmp(argv[i - 1], "-rockets"))
+			options.rockets = atoi(value);
+		else if(!strcmp(argv[i - 1], "-smoke"))
+			options.smoke = atoi(value);
+		else
+			usage();
+	}
+	if(options.frameTime <= 0.0f || options.seconds < 0.0f || !options.seed || options.width < 1
+		|| options.height < 1 || options.rockets < 1 || options.smoke < 1)
+		usage();
+
+	if(!makeContext()){
+		fprintf(stderr, "skyrocket_smokebench: can't make an OpenGL context\n");
+		return 1;
+	}
+	// Draw into an offscreen framebuffer, which oit.h composites back into
+	GLuint framebuffer, colorbuffer;
+	glGenFramebuffersEXT(1, &framebuffer);
+	glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, framebuffer);
+	glGenRenderbuffersEXT(1, &colorbuffer);
+	glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, colorbuffer);
+	glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_RGBA8, options.width, options.height);
+	glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_RENDERBUFFER_EXT, colorbuffer);
+	if(glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT) != GL_FRAMEBUFFER_COMPLETE_EXT){
+		fprintf(stderr, "skyrocket_smokebench: can't make a framebuffer\n");
+		return 1;
+	}
+	// same state as initSaver()
+	glViewport(0, 0, options.width, options.height);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_TEXTURE_2D);
+	glFrontFace(GL_CCW);
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+
+	SkyrocketSaverSettings* settings = new SkyrocketSaverSettings();
+	setDefaults(settings);
+	settings->dSeed = options.seed;
+	settings->dMaxrockets = options.rockets;
+	settings->dSmoke = options.smoke;
+	settings->dExplosionsmoke = 50;
+	initSim(options.width, options.height, settings);
+	rsRandom textureRandom;
+	textureRandom.seed(~uint64_t(settings->seed));
+	rsCurrentRandom = &textureRandom;
+	initSmoke(settings);
+	rsCurrentRandom = &settings->random;
+	if(!initOit(options.width, options.height)){
+		fprintf(stderr, "skyrocket_smokebench: OpenGL can't do weighted blended transparency\n");
+		return 1;
+	}
+	const int instanced(initBillboards());
+	const char* extensions((const char*)glGetString(GL_EXTENSIONS));
+	GLuint query(0);
+	if(extensions && strstr(extensions, "GL_ARB_timer_query"))
+		glGenQueries(1, &query);
+
+	const int frames(int(options.seconds / options.frameTime + 0.5f));
+	renderQueue queue;
+	drawCost sortedCost = drawCost(), weightedCost = drawCost();
+	double sortTime(0.0);
+	unsigned int peak(0);
+	for(int frame=0; frame<frames; ++frame){
+		stepSim(options.frameTime, settings);
+		viewMatrices(settings);
+		glMatrixMode(GL_PROJECTION);
+		glLoadMatrixd(settings->projMat);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadMatrixd(settings->modelMat);
+		const float t(settings->kFireworks ? settings->tickFraction : 1.0f);
+		settings->onScreen.cull(settings->particles, settings->last_particle, settings->modelMat,
+			settings->projMat, t, settings->dSimd);
+		const double sortStart(benchClock());
+		settings->smokeOrder.sort(settings->particles, settings->onScreen.visible, settings->modelMat, t);
+		sortTime += benchClock() - sortStart;
+
+		timeSmoke(queue, SMOKEBLEND_SORT, query, sortedCost, settings);
+		if(queue.smoke.size() > peak)
+			peak = queue.smoke.size();
+		timeSmoke(queue, SMOKEBLEND_WEIGHTED, query, weightedCost, settings);
+	}
+
+	printf("{\n");
+	printf("  \"seconds\": %g,\n", options.seconds);
+	printf("  \"frameTime\": %g,\n", options.frameTime);
+	printf("  \"seed\": %u,\n", settings->seed);
+	printf("  \"width\": %d,\n", options.width);
+	printf("  \"height\": %d,\n", options.height);
+	printf("  \"frames\": %d,\n", frames);
+	printf("  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+	printf("  \"instancedBillboards\": %s,\n", instanced ? "true" : "false");
+	printf("  \"timerQuery\": %s,\n", query ? "true" : "false");
+	printf("  \"peakSmoke\": %u,\n", peak);
+	printf("  \"smoke\": {\n");
+	printCost("sorted", sortedCost, sortTime, false);
+	printCost("weighted", weightedCost, 0.0, true);
+	printf("  }\n");
+	printf("}\n");
+
+	if(query)
+		glDeleteQueries(1, &query);
+	cleanupOit();
+	cleanupBillboards();
+	cleanupSim(settings);
+	delete settings;
+	glDeleteRenderbuffersEXT(1, &colorbuffer);
+	glDeleteFramebuffersEXT(1, &framebuffer);
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "smokelight.h"
+#include "particlegrid.h"
+#include "workerpool.h"
+#include <math.h>
+
+
+// Less smoke than this per thread isn't worth waking the other threads for
+#define SMOKEPERJOB 1000
+
+
+
+static float lightReach(const smokeLight &light){
+	return sqrtf(light.reachSquared);
+}
+
+
+void smokeLighting::add(const float* xyz, const float* rgb, float bright, float reachSquared, float scale){
+	smokeLight light;
+	for(unsigned int j=0; j<3; ++j){
+		light.xyz[j] = xyz[j];
+		light.rgb[j] = rgb[j];
+	}
+	light.bright = bright;
+	light.reachSquared = reachSquared;
+	light.scale = scale;
+	lights.push_back(light);
+}
+
+
+void smokeLighting::shine(particleStore &inStore, const particleGrid &inGrid, float inAmbient, workerPool* workers){
+	// sort lights into the cells they reach, keeping them in order
+	bins.sort(inGrid, lights, lightReach);
+
+	store = &inStore;
+	grid = &inGrid;
+	ambient = inAmbient;
+	inGrid.dealCells(workers, inGrid.numSmoke, SMOKEPERJOB, shineCell, this);
+}
+
+
+void smokeLighting::shineCell(unsigned int c, void* data){
+	smokeLighting* lighting = (smokeLighting*)data;
+	particleStore& store(*lighting->store);
+	const particleGrid& grid(*lighting->grid);
+	const unsigned int stride(store.capacity);
+	const float* x(store.xyz);
+	const float* y(store.xyz + stride);
+	const float* z(store.xyz + stride + stride);
+	float* r(store.rgb);
+	float* g(store.rgb + stride);
+	float* b(store.rgb + stride + stride);
+	const float ambient(lighting->ambient);
+	const smokeLight* lights(lighting->lights.empty() ? NULL : &lighting->lights[0]);
+
+	const unsigned int* smoke;
+	const unsigned int numSmoke(grid.cellParticles(c, GRID_SMOKE, smoke));
+	const unsigned int* cellLights;
+	const unsigned int numLights(lighting->bins.cellItems(c, cellLights));
+	for(unsigned int s=0; s<numSmoke; ++s){
+		const unsigned int i(smoke[s]);
+		float sr(ambient), sg(ambient), sb(ambient);
+		for(unsigned int n=0; n<numLights; ++n){
+			const smokeLight& light(lights[cellLights[n]]);
+			const float dx(light.xyz[0] - x[i]);
+			const float dy(light.xyz[1] - y[i]);
+			const float dz(light.xyz[2] - z[i]);
+			const float distsquared(dx * dx + dy * dy + dz * dz);
+			if(distsquared < light.reachSquared){
+				float temp((light.reachSquared - distsquared) * light.scale);
+				temp = temp * temp * light.bright;
+				sr += temp * light.rgb[0];
+				if(sr > 1.0f)
+					sr = 1.0f;
+				sg += temp * light.rgb[1];
+				if(sg > 1.0f)
+					sg = 1.0f;
+				sb += temp * light.rgb[2];
+				if(sb > 1.0f)
+					sb = 1.0f;
+			}
+		}
+		r[i] = sr;
+		g[i] = sg;
+		b[i] = sb;
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef SMOKELIGHT_H
+#define SMOKELIGHT_H
+
+
+
+#include "particlegrid.h"
+#include <vector>
+
+class workerPool;
+
+
+// A rocket, fountain, or explosion shining on smoke this frame
+struct smokeLight{
+	float xyz[3];
+	float rgb[3];  // desaturated light color
+	float bright;
+	float reachSquared;  // smoke farther away than this (squared) gets no light
+	float scale;
+};
+
+
+// Lights smoke by gathering:  every SMOKE particle starts at the ambient light
+// and adds up the lights that reach it, so each particle's color is written by
+// exactly one thread.  Lights are collected during the frame with add() and
+// sorted into the grid's cells so that smoke only looks at lights near it.
+class smokeLighting{
+public:
+	std::vector<smokeLight> lights;
+
+	void clear() {lights.clear();}
+	void add(const float* xyz, const float* rgb, float bright, float reachSquared, float scale);
+	// Set the color of every SMOKE particle in grid, which must be up to date
+	// for store.  Uses the worker threads when there is enough smoke.
+	void shine(particleStore &store, const particleGrid &grid, float ambient, workerPool* workers);
+
+private:
+	cellBins bins;  // lights sorted into the cells they reach
+	// for shineCell()
+	particleStore* store;
+	const particleGrid* grid;
+	float ambient;
+
+	static void shineCell(unsigned int c, void* data);
+};
+
+
+
+#endif
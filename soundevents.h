@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef SOUNDEVENTS_H
+#define SOUNDEVENTS_H
+
+
+
+#include "rsMath.h"
+
+struct SkyrocketSaverSettings;
+
+
+#define LAUNCH1SOUND 0
+#define LAUNCH2SOUND 1
+#define BOOM1SOUND 2
+#define BOOM2SOUND 3
+#define BOOM3SOUND 4
+#define BOOM4SOUND 5
+#define POPPERSOUND 6
+#define SUCKSOUND 7
+#define NUKESOUND 8
+#define WHISTLESOUND 9
+
+
+// A sound the simulation wants played.  Events pile up in the settings'
+// soundEvents during updateSim() and are handed to the SoundEngine (or to
+// whoever else is listening) afterwards.  They are cleared every frame.
+struct soundEvent{
+	int sound;
+	float pos[3];
+};
+
+// Ask for sound to be played at pos
+void queueSound(int sound, const rsVec &pos, SkyrocketSaverSettings *inSettings);
+
+
+
+#endif
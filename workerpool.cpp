@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "workerpool.h"
+
+
+
+workerPool::workerPool(unsigned int numThreads){
+	numJobs = numThreads ? numThreads : 1;
+	generation = 0;
+	busy = 0;
+	quit = false;
+	jobFunc = NULL;
+	jobData = NULL;
+	for(unsigned int i=1; i<numJobs; ++i)
+		threads.push_back(std::thread(&workerPool::work, this, i));
+}
+
+
+workerPool::~workerPool(){
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for(unsigned int i=0; i<threads.size(); ++i)
+		threads[i].join();
+}
+
+
+void workerPool::run(void (*func)(unsigned int job, void* data), void* data){
+	if(numJobs > 1){
+		std::lock_guard<std::mutex> lock(mutex);
+		jobFunc = func;
+		jobData = data;
+		busy = numJobs - 1;
+		++generation;
+	}
+	wake.notify_all();
+
+	func(0, data);
+
+	if(numJobs > 1){
+		std::unique_lock<std::mutex> lock(mutex);
+		while(busy)
+			finished.wait(lock);
+	}
+}
+
+
+void workerPool::work(unsigned int job){
+	unsigned int lastGeneration = 0;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while(1){
+		while(!quit && generation == lastGeneration)
+			wake.wait(lock);
+		if(quit)
+			return;
+		lastGeneration = generation;
+
+		lock.unlock();
+		jobFunc(job, jobData);
+		lock.lock();
+
+		if(--busy == 0)
+			finished.notify_one();
+	}
+}
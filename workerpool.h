@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 1999-2010  Terence M. Welsh
+ *
+ * This file is part of Skyrocket.
+ *
+ * Skyrocket is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License,
+ * or (at your option) any later version.
+ *
+ * Skyrocket is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+// A fixed set of threads that all run the same job at once.  The thread that
+// calls run() does job 0 itself, so a pool of size 1 starts no threads at all.
+class workerPool{
+public:
+	workerPool(unsigned int numThreads);
+	~workerPool();
+	unsigned int size() const {return numJobs;}
+	// Call func(job, data) for every job from 0 to size()-1 and wait for all of them
+	void run(void (*func)(unsigned int job, void* data), void* data);
+
+private:
+	unsigned int numJobs;
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;  // signals workers that a new job has been posted
+	std::condition_variable finished;  // signals run() that the workers are done
+	unsigned int generation;  // incremented for every job
+	unsigned int busy;  // workers still running the current job
+	bool quit;
+	void (*jobFunc)(unsigned int, void*);
+	void* jobData;
+
+	void work(unsigned int job);
+	workerPool(const workerPool&);
+	workerPool & operator = (const workerPool&);
+};
+
+
+
+#endif
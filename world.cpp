@@ -18,365 +18,161 @@
  */
 
 
+
 /*#include <Skyrocket/world.h>
 #include <rsMath/rsMath.h>
-#include <Skyrocket/flare.h>
-#include <Skyrocket/cloudtex.h>
-#include <Skyrocket/moontex.h>
-#include <Skyrocket/earthtex.h>
 #include <math.h>*/
 #include "world.h"
 #include "rsMath.h"
-#include "flare.h"
-#include "cloudtex.h"
-#include "moontex.h"
-#include "earthtex.h"
 #include <math.h>
 
+#if defined(__x86_64__) || defined(__SSE2__)
+#define WORLD_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#define WORLD_NEON
+#include <arm_neon.h>
+#endif
+
+
+
+// A tile's cloud vertices, copied out of clouds[][] for lighting
+struct cloudTile{
+	float x[CLOUDTILE * CLOUDTILE], y[CLOUDTILE * CLOUDTILE], z[CLOUDTILE * CLOUDTILE];
+	float r[CLOUDTILE * CLOUDTILE], g[CLOUDTILE * CLOUDTILE], b[CLOUDTILE * CLOUDTILE];
+};
+
+
+// Add light to tile vertices first to last.  Reference version.  The SIMD
+// kernels do the same operations in the same order.
+static void shineScalar(const cloudLight &light, cloudTile &tile, int first, int last){
+	for(int v=first; v<last; ++v){
+		const float distsquared((tile.x[v] - light.xyz[0]) * (tile.x[v] - light.xyz[0])
+			+ (tile.y[v] - light.xyz[1]) * (tile.y[v] - light.xyz[1])
+			+ (tile.z[v] - light.xyz[2]) * (tile.z[v] - light.xyz[2]));
+		if(distsquared < 2560000.0f){
+			float temp = (2560000.0f - distsquared) * 0.000000390625f;
+			temp = temp * temp * light.bright;
+			tile.r[v] += temp * light.rgb[0];
+			if(tile.r[v] > 1.0f)
+				tile.r[v] = 1.0f;
+			tile.g[v] += temp * light.rgb[1];
+			if(tile.g[v] > 1.0f)
+				tile.g[v] = 1.0f;
+			tile.b[v] += temp * light.rgb[2];
+			if(tile.b[v] > 1.0f)
+				tile.b[v] = 1.0f;
+		}
+	}
+}
 
 
-World::World(SkyrocketSaverSettings *inSettings){
-	int i, j;
-	float x, y, z;	
+#ifdef WORLD_SSE2
+static void shineSSE2(const cloudLight &light, cloudTile &tile, int first, int last){
+	const __m128 lx(_mm_set1_ps(light.xyz[0]));
+	const __m128 ly(_mm_set1_ps(light.xyz[1]));
+	const __m128 lz(_mm_set1_ps(light.xyz[2]));
+	const __m128 lr(_mm_set1_ps(light.rgb[0]));
+	const __m128 lg(_mm_set1_ps(light.rgb[1]));
+	const __m128 lb(_mm_set1_ps(light.rgb[2]));
+	const __m128 bright(_mm_set1_ps(light.bright));
+	const __m128 reach(_mm_set1_ps(2560000.0f));
+	const __m128 scale(_mm_set1_ps(0.000000390625f));
+	const __m128 one(_mm_set1_ps(1.0f));
+	int v(first);
+	for(; v+4<=last; v+=4){
+		const __m128 dx(_mm_sub_ps(_mm_loadu_ps(tile.x + v), lx));
+		const __m128 dy(_mm_sub_ps(_mm_loadu_ps(tile.y + v), ly));
+		const __m128 dz(_mm_sub_ps(_mm_loadu_ps(tile.z + v), lz));
+		const __m128 distsquared(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		const __m128 lit(_mm_cmplt_ps(distsquared, reach));
+		__m128 temp(_mm_mul_ps(_mm_sub_ps(reach, distsquared), scale));
+		temp = _mm_mul_ps(_mm_mul_ps(temp, temp), bright);
+		// vertices out of reach keep their color
+		const __m128 r(_mm_loadu_ps(tile.r + v));
+		const __m128 g(_mm_loadu_ps(tile.g + v));
+		const __m128 b(_mm_loadu_ps(tile.b + v));
+		const __m128 litr(_mm_min_ps(_mm_add_ps(r, _mm_mul_ps(temp, lr)), one));
+		const __m128 litg(_mm_min_ps(_mm_add_ps(g, _mm_mul_ps(temp, lg)), one));
+		const __m128 litb(_mm_min_ps(_mm_add_ps(b, _mm_mul_ps(temp, lb)), one));
+		_mm_storeu_ps(tile.r + v, _mm_or_ps(_mm_and_ps(lit, litr), _mm_andnot_ps(lit, r)));
+		_mm_storeu_ps(tile.g + v, _mm_or_ps(_mm_and_ps(lit, litg), _mm_andnot_ps(lit, g)));
+		_mm_storeu_ps(tile.b + v, _mm_or_ps(_mm_and_ps(lit, litb), _mm_andnot_ps(lit, b)));
+	}
+	shineScalar(light, tile, v, last);
+}
+#endif
+
+
+#ifdef WORLD_NEON
+static void shineNEON(const cloudLight &light, cloudTile &tile, int first, int last){
+	const float32x4_t lx(vdupq_n_f32(light.xyz[0]));
+	const float32x4_t ly(vdupq_n_f32(light.xyz[1]));
+	const float32x4_t lz(vdupq_n_f32(light.xyz[2]));
+	const float32x4_t lr(vdupq_n_f32(light.rgb[0]));
+	const float32x4_t lg(vdupq_n_f32(light.rgb[1]));
+	const float32x4_t lb(vdupq_n_f32(light.rgb[2]));
+	const float32x4_t bright(vdupq_n_f32(light.bright));
+	const float32x4_t reach(vdupq_n_f32(2560000.0f));
+	const float32x4_t scale(vdupq_n_f32(0.000000390625f));
+	const float32x4_t one(vdupq_n_f32(1.0f));
+	int v(first);
+	for(; v+4<=last; v+=4){
+		const float32x4_t dx(vsubq_f32(vld1q_f32(tile.x + v), lx));
+		const float32x4_t dy(vsubq_f32(vld1q_f32(tile.y + v), ly));
+		const float32x4_t dz(vsubq_f32(vld1q_f32(tile.z + v), lz));
+		const float32x4_t distsquared(vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz)));
+		const uint32x4_t lit(vcltq_f32(distsquared, reach));
+		float32x4_t temp(vmulq_f32(vsubq_f32(reach, distsquared), scale));
+		temp = vmulq_f32(vmulq_f32(temp, temp), bright);
+		// vertices out of reach keep their color
+		const float32x4_t r(vld1q_f32(tile.r + v));
+		const float32x4_t g(vld1q_f32(tile.g + v));
+		const float32x4_t b(vld1q_f32(tile.b + v));
+		vst1q_f32(tile.r + v, vbslq_f32(lit, vminq_f32(vaddq_f32(r, vmulq_f32(temp, lr)), one), r));
+		vst1q_f32(tile.g + v, vbslq_f32(lit, vminq_f32(vaddq_f32(g, vmulq_f32(temp, lg)), one), g));
+		vst1q_f32(tile.b + v, vbslq_f32(lit, vminq_f32(vaddq_f32(b, vmulq_f32(temp, lb)), one), b));
+	}
+	shineScalar(light, tile, v, last);
+}
+#endif
 
-	// Initialize cloud texture object even if clouds are not turned on.
-	// Sunsets and shockwaves can also use cloud texture.
-	glGenTextures(1, &cloudtex);
-	glBindTexture(GL_TEXTURE_2D, cloudtex);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	gluBuild2DMipmaps(GL_TEXTURE_2D, 2, CLOUDTEXSIZE, CLOUDTEXSIZE, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, cloudmap);
 
-	// initialize star texture
-	if(inSettings->dStardensity){
-		unsigned char starmap[STARTEXSIZE][STARTEXSIZE][3];
-		for(i=0; i<STARTEXSIZE; i++){
-			for(j=0; j<STARTEXSIZE; j++){
-				starmap[i][j][0] = starmap[i][j][1] = starmap[i][j][2] = 0;
-			}
-		}
-		int u, v;
-		unsigned int rgb[3];
-		for(i=0; i<(inSettings->dStardensity*100); i++){
-			u = rsRandi(STARTEXSIZE-4) + 2;
-			v = rsRandi(STARTEXSIZE-4) + 2;
-			rgb[0] = 220 + rsRandi(36);
-			rgb[1] = 220 + rsRandi(36);
-			rgb[2] = 220 + rsRandi(36);
-			rgb[rsRandi(3)] = 255;
-			starmap[u][v][0] = rgb[0];
-			starmap[u][v][1] = rgb[1];
-			starmap[u][v][2] = rgb[2];
-			switch(rsRandi(15)){  // different stars
-			case 0:  // small
-			case 1:
-			case 2:
-			case 3:
-			case 4:
-			case 5:
-			case 6:
-			case 7:
-				starmap[u][v][0] /= 2;
-				starmap[u][v][1] /= 2;
-				starmap[u][v][2] /= 2;
-				break;
-			case 8:  // medium
-			case 9:
-			case 10:
-			case 11:
-				starmap[u+1][v][0]=starmap[u-1][v][0]=starmap[u][v+1][0]=starmap[u][v-1][0]=rgb[0]/4;
-				starmap[u+1][v][1]=starmap[u-1][v][1]=starmap[u][v+1][1]=starmap[u][v-1][1]=rgb[1]/4;
-				starmap[u+1][v][2]=starmap[u-1][v][2]=starmap[u][v+1][2]=starmap[u][v-1][2]=rgb[2]/4;
-				starmap[u+1][v+1][0]=starmap[u+1][v-1][0]=starmap[u-1][v+1][0]=starmap[u-1][v-1][0]=rgb[0]/8;
-				starmap[u+1][v+1][1]=starmap[u+1][v-1][1]=starmap[u-1][v+1][1]=starmap[u-1][v-1][1]=rgb[1]/8;
-				starmap[u+1][v+1][2]=starmap[u+1][v-1][2]=starmap[u-1][v+1][2]=starmap[u-1][v-1][2]=rgb[2]/8;
-				break;
-			case 12:  // large
-			case 13:
-				starmap[u+1][v][0]=starmap[u-1][v][0]=starmap[u][v+1][0]=starmap[u][v-1][0]=rgb[0]/2;
-				starmap[u+1][v][1]=starmap[u-1][v][1]=starmap[u][v+1][1]=starmap[u][v-1][1]=rgb[1]/2;
-				starmap[u+1][v][2]=starmap[u-1][v][2]=starmap[u][v+1][2]=starmap[u][v-1][2]=rgb[2]/2;
-				starmap[u+1][v+1][0]=starmap[u+1][v-1][0]=starmap[u-1][v+1][0]=starmap[u-1][v-1][0]=rgb[0]/4;
-				starmap[u+1][v+1][1]=starmap[u+1][v-1][1]=starmap[u-1][v+1][1]=starmap[u-1][v-1][1]=rgb[1]/4;
-				starmap[u+1][v+1][2]=starmap[u+1][v-1][2]=starmap[u-1][v+1][2]=starmap[u-1][v-1][2]=rgb[2]/4;
-				break;
-			case 14:  // X-large
-				starmap[u+1][v][0]=starmap[u-1][v][0]=starmap[u][v+1][0]=starmap[u][v-1][0]=rgb[0];
-				starmap[u+1][v][1]=starmap[u-1][v][1]=starmap[u][v+1][1]=starmap[u][v-1][1]=rgb[1];
-				starmap[u+1][v][2]=starmap[u-1][v][2]=starmap[u][v+1][2]=starmap[u][v-1][2]=rgb[2];
-				starmap[u+1][v+1][0]=starmap[u+1][v-1][0]=starmap[u-1][v+1][0]=starmap[u-1][v-1][0]=rgb[0]/2;
-				starmap[u+1][v+1][1]=starmap[u+1][v-1][1]=starmap[u-1][v+1][1]=starmap[u-1][v-1][1]=rgb[1]/2;
-				starmap[u+1][v+1][2]=starmap[u+1][v-1][2]=starmap[u-1][v+1][2]=starmap[u-1][v-1][2]=rgb[2]/2;
-			}
-		}
-		/*if(dAmbient > 50){  // blue sky replaces stars (like it's daytime)
-			const float black(float(100 - dAmbient) / 50.0f);
-			const unsigned char blue((unsigned char)(float(dAmbient - 50) * 255.0f / 50.0f)); 
-			for(i=0; i<STARTEXSIZE; i++){
-				for(j=0; j<STARTEXSIZE; j++){
-					starmap[i][j][0] = (unsigned char)(float(starmap[i][j][0]) * black);
-					starmap[i][j][1] = (unsigned char)(float(starmap[i][j][1]) * black);
-					starmap[i][j][2] = (unsigned char)(float(starmap[i][j][2]) * black);
-					starmap[i][j][0] += blue / 4;
-					starmap[i][j][1] += blue / 4;
-					starmap[i][j][2] += blue;
-				}
-			}
-		}*/
-		glGenTextures(1, &startex);
-		glBindTexture(GL_TEXTURE_2D, startex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, STARTEXSIZE, STARTEXSIZE, GL_RGB, GL_UNSIGNED_BYTE, starmap);
-	}
+static void shine(const cloudLight &light, cloudTile &tile, int first, int last){
+#if defined(WORLD_SSE2)
+	shineSSE2(light, tile, first, last);
+#elif defined(WORLD_NEON)
+	shineNEON(light, tile, first, last);
+#else
+	shineScalar(light, tile, first, last);
+#endif
+}
 
-	//initialize moon texture
-	if(inSettings->dMoon){
-		glGenTextures(1, &moontex);
-		glBindTexture(GL_TEXTURE_2D, moontex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 2, MOONTEXSIZE, MOONTEXSIZE, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, moonmap);
-	}
 
-	//initialize moon glow texture
-	if(inSettings->dMoonglow){
-		unsigned char moonglowmap[MOONGLOWTEXSIZE][MOONGLOWTEXSIZE][3];
-		float temp1, temp2, temp3, u, v;
-		for(i=0; i<MOONGLOWTEXSIZE; i++){
-			for(j=0; j<MOONGLOWTEXSIZE; j++){
-				u = float(i - MOONGLOWTEXSIZE / 2) / float(MOONGLOWTEXSIZE / 2);
-				v = float(j - MOONGLOWTEXSIZE / 2) / float(MOONGLOWTEXSIZE / 2);
-				temp1 = 4.0f * ((u * u) + (v * v)) * (1.0f - ((u * u) + (v * v)));
-				if(temp1 > 1.0f)
-					temp1 = 1.0f;
-				if(temp1 < 0.0f)
-					temp1 = 0.0f;
-				temp1 = temp1 * temp1 * temp1 * temp1;
-				u *= 1.2f;
-				v *= 1.2f;
-				temp2 = 4.0f * ((u * u) + (v * v)) * (1.0f - ((u * u) + (v * v)));
-				if(temp2 > 1.0f)
-					temp2 = 1.0f;
-				if(temp2 < 0.0f)
-					temp2 = 0.0f;
-				temp2 = temp2 * temp2 * temp2 * temp2;
-				u *= 1.25f;
-				v *= 1.25f;
-				temp3 = 4.0f * ((u * u) + (v * v)) * (1.0f - ((u * u) + (v * v)));
-				if(temp3 > 1.0f)
-					temp3 = 1.0f;
-				if(temp3 < 0.0f)
-					temp3 = 0.0f;
-				temp3 = temp3 * temp3 * temp3 * temp3;
-				//moonglowmap[i][j][0] = (unsigned char)(255.0f * (temp1 * 0.4f + temp2 * 0.4f + temp3 * 0.48f));
-				//moonglowmap[i][j][1] = (unsigned char)(255.0f * (temp1 * 0.4f + temp2 * 0.48f + temp3 * 0.38f));
-				//moonglowmap[i][j][2] = (unsigned char)(255.0f * (temp1 * 0.48f + temp2 * 0.4f + temp3 * 0.38f));
-				moonglowmap[i][j][0] = (unsigned char)(255.0f * (temp1 * 0.45f + temp2 * 0.4f + temp3 * 0.6f));
-				moonglowmap[i][j][1] = (unsigned char)(255.0f * (temp1 * 0.45f + temp2 * 0.54f + temp3 * 0.45f));
-				moonglowmap[i][j][2] = (unsigned char)(255.0f * (temp1 * 0.6f + temp2 * 0.4f + temp3 * 0.45f));
-				//moonglowmap[i][j][3] = (unsigned char)(255.0f * (temp1 * 0.48f + temp2 * 0.48f + temp3 * 0.48f));
-			}
-		}
-		glGenTextures(1, &moonglowtex);
-		glBindTexture(GL_TEXTURE_2D, moonglowtex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, MOONGLOWTEXSIZE, MOONGLOWTEXSIZE, GL_RGB, GL_UNSIGNED_BYTE, moonglowmap);
-	}
+
+World::World(SkyrocketSaverSettings *inSettings){
+	int i, j;
+	float x, z;
+
+	// made by initGL()
+	cloudBuffer = cloudColorBuffer = cloudIndexBuffer = 0;
 
 	// do a sunset?
 	doSunset = 1;
 	if(!rsRandi(4))
 		doSunset = 0;
-	// initialize sunset texture
-	if(doSunset){
-		unsigned char sunsetmap[CLOUDTEXSIZE][CLOUDTEXSIZE][3];
-		unsigned char rgb[3];
-		float temp;
-		if(rsRandi(3))
-			rgb[0] = 60 + rsRandi(42);
-		else
-			rgb[0] = rsRandi(102);
-		rgb[1] = rsRandi(rgb[0]);
-		rgb[2] = 0;
-		if(rgb[1] < 50)
-			rgb[2] = 100 - rsRandi(rgb[0]);
-		for(i=0; i<CLOUDTEXSIZE; i++){
-			for(j=0; j<CLOUDTEXSIZE; j++){
-				sunsetmap[i][j][0] = rgb[0];
-				sunsetmap[i][j][1] = rgb[1];
-				sunsetmap[i][j][2] = rgb[2];
-			}
-		}
-		// clouds in sunset
-		if(rsRandi(3)){
-			float cloudinf;  // influence of clouds
-			int xoffset = rsRandi(CLOUDTEXSIZE);
-			int yoffset = rsRandi(CLOUDTEXSIZE);
-			int x, y;
-			for(i=0; i<CLOUDTEXSIZE; i++){
-				for(j=0; j<CLOUDTEXSIZE; j++){
-					x = (i + xoffset) % CLOUDTEXSIZE;
-					y = (j + yoffset) % CLOUDTEXSIZE;
-					cloudinf = float(cloudmap[x][y][1]) / 256.0f;
-					temp = float(sunsetmap[i][j][0]) / 256.0f;
-					temp *= cloudinf;
-					sunsetmap[i][j][0] = (unsigned char)(temp * 256.0f);
-					cloudinf *= float(cloudmap[x][y][0]) / 256.0f;
-					temp = float(sunsetmap[i][j][1]) / 256.0f;
-					temp *= cloudinf;
-					sunsetmap[i][j][1] = (unsigned char)(temp * 256.0f);
-				}
-			}
-		}
-		// Fractal mountain generation
-		int mountains[CLOUDTEXSIZE+1];
-		mountains[0] = mountains[CLOUDTEXSIZE] = rsRandi(10) + 5;
-		makeHeights(0, CLOUDTEXSIZE, mountains);
-		for(i=0; i<CLOUDTEXSIZE; i++){
-			for(j=0; j<=mountains[i]; j++){
-				sunsetmap[i][j][0] = 0;
-				sunsetmap[i][j][1] = 0;
-				sunsetmap[i][j][2] = 0;
-			}
-			sunsetmap[i][mountains[i]+1][0] /= 4;
-			sunsetmap[i][mountains[i]+1][1] /= 4;
-			sunsetmap[i][mountains[i]+1][2] /= 4;
-			sunsetmap[i][mountains[i]+2][0] /= 2;
-			sunsetmap[i][mountains[i]+2][1] /= 2;
-			sunsetmap[i][mountains[i]+2][2] /= 2;
-			sunsetmap[i][mountains[i]+3][0] = (unsigned char)(float(sunsetmap[i][mountains[i]+3][0]) * 0.75f);
-			sunsetmap[i][mountains[i]+3][1] = (unsigned char)(float(sunsetmap[i][mountains[i]+3][1]) * 0.75f);
-			sunsetmap[i][mountains[i]+3][2] = (unsigned char)(float(sunsetmap[i][mountains[i]+3][2]) * 0.75f);
-		}
-		// build texture object
-		glGenTextures(1, &sunsettex);
-		glBindTexture(GL_TEXTURE_2D, sunsettex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, CLOUDTEXSIZE, CLOUDTEXSIZE, GL_RGB, GL_UNSIGNED_BYTE, sunsetmap);
-	}
-
-	//initialize earth texture
-	if(inSettings->dEarth){
-		glGenTextures(1, &earthneartex);
-		glBindTexture(GL_TEXTURE_2D, earthneartex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, EARTHNEARSIZE, EARTHNEARSIZE, GL_RGB, GL_UNSIGNED_BYTE, earthnearmap);
-		glGenTextures(1, &earthfartex);
-		glBindTexture(GL_TEXTURE_2D, earthfartex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, EARTHFARSIZE, EARTHFARSIZE, GL_RGB, GL_UNSIGNED_BYTE, earthfarmap);
-		glGenTextures(1, &earthlighttex);
-		glBindTexture(GL_TEXTURE_2D, earthlighttex);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		gluBuild2DMipmaps(GL_TEXTURE_2D, 3, EARTHFARSIZE, EARTHFARSIZE, GL_RGB, GL_UNSIGNED_BYTE, earthlightmap);
-	}
 
-	// initialize star geometry
-	if(inSettings->dStardensity){
-		for(j=0; j<STARMESH/2; j++){
-			y = sinf(RS_PIo2 * float(j) / float(STARMESH/2));
-			for(i=0; i<=STARMESH; i++){
-				x = cosf(RS_PIx2 * float(i) / float(STARMESH)) * cosf(RS_PIo2 * float(j) / float(STARMESH/2));
-				z = sinf(RS_PIx2 * float(i) / float(STARMESH)) * cosf(RS_PIo2 * float(j) / float(STARMESH/2));
-				// positions
-				stars[i][j][0] = x * 20000.0f;
-				stars[i][j][1] = 1500.0f + 18500.0f * y;
-				stars[i][j][2] = z * 20000.0f;
-				// tex coords
-				stars[i][j][3] = 1.0f * x * (2.0f - y);
-				stars[i][j][4] = 1.0f * z * (2.0f - y);
-				// brightness
-				if(stars[i][j][1] < 1501.0f)
-					stars[i][j][5] = 0.0f;
-				else
-					stars[i][j][5] = 1.0f;
-			}
-		}
-		starlist = glGenLists(1);
-		glNewList(starlist, GL_COMPILE);
-			glBindTexture(GL_TEXTURE_2D, startex);
-			for(j=0; j<(STARMESH/2-1); j++){
-				glBegin(GL_TRIANGLE_STRIP);
-				for(i=0; i<=STARMESH; i++){
-					glColor3f(stars[i][j+1][5], stars[i][j+1][5], stars[i][j+1][5]);
-					glTexCoord2f(stars[i][j+1][3], stars[i][j+1][4]);
-					glVertex3fv(stars[i][j+1]);
-					glColor3f(stars[i][j][5], stars[i][j][5], stars[i][j][5]);
-					glTexCoord2f(stars[i][j][3], stars[i][j][4]);
-					glVertex3fv(stars[i][j]);
-				}
-				glEnd();
-			}
-			j = STARMESH / 2 - 1;
-			glBegin(GL_TRIANGLE_FAN);
-			glColor3f(1.0f, 1.0f, 1.0f);
-			glTexCoord2f(0.0f, 0.0f);
-			glVertex3f(0.0f, 20000.0f, 0.0f);
-			for(i=0; i<=STARMESH; i++){
-				glColor3f(stars[i][j][5], stars[i][j][5], stars[i][j][5]);
-				glTexCoord2f(stars[i][j][3], stars[i][j][4]);
-				glVertex3fv(stars[i][j]);
-			}
-			glEnd();
-		glEndList();
-	}
-
-	// initialize moon geometry
+	// position the moon
 	if(inSettings->dMoon){
 		moonRotation = rsRandf(360.0f);
 		moonHeight = rsRandf(40.0f) + 20.0f;
-		moonlist = glGenLists(1);
-		glNewList(moonlist, GL_COMPILE);
-			glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-			glBindTexture(GL_TEXTURE_2D, moontex);
-			glBegin(GL_TRIANGLE_STRIP);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(-800.0f, -800.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex3f(800.0f, -800.0f, 0.0f);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(-800.0f, 800.0f, 0.0f);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(800.0f, 800.0f, 0.0f);
-			glEnd();
-		glEndList();
-	}
-
-	// initialize moon glow geometry
-	if(inSettings->dMoonglow){
-		moonglowlist = glGenLists(1);
-		glNewList(moonglowlist, GL_COMPILE);
-			glBindTexture(GL_TEXTURE_2D, moonglowtex);
-			glBegin(GL_TRIANGLE_STRIP);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(-7000.0f, -7000.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex3f(7000.0f, -7000.0f, 0.0f);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(-7000.0f, 7000.0f, 0.0f);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(7000.0f, 7000.0f, 0.0f);
-			glEnd();
-		glEndList();
 	}
 
 	// initialize cloud geometry
+	cloudShift = 0.0f;
+	litWest = litSouth = 0;
+	litEast = litNorth = -1;  // nothing lit
 	if(inSettings->dClouds){
-		cloudShift = 0.0f;
 		for(j=0; j<=CLOUDMESH; j++){
 			for(i=0; i<=CLOUDMESH; i++){
 				x = float(i - (CLOUDMESH / 2));
@@ -386,341 +182,151 @@ World::World(SkyrocketSaverSettings *inSettings){
 				x = float(fabs(x / float(CLOUDMESH / 2)));
 				z = float(fabs(z / float(CLOUDMESH / 2)));
 				clouds[i][j][1] = 2000.0f - 1000.0f * float(x * x + z * z);
-				clouds[i][j][3] = float(-i) / float(CLOUDMESH / 6);  // tex coords
+				clouds[i][j][3] = float(-i) * (1.0f / float(CLOUDMESH / 6));  // tex coords
 				clouds[i][j][4] = float(-j) / float(CLOUDMESH / 6);
 				clouds[i][j][5] = (clouds[i][j][1] - 1000.0f) * 0.00001f * float(inSettings->dAmbient);  // brightness
 				if(clouds[i][j][5] < 0.0f)
 					clouds[i][j][5] = 0.0f;
+				clouds[i][j][6] = clouds[i][j][7] = clouds[i][j][8] = clouds[i][j][5];
 			}
 		}
 	}
-
-	// initialize sunset geometry
-	if(doSunset){
-		sunsetlist = glGenLists(1);
-		float vert[6] = {0.0f, 7654.0f, 8000.0f, 14142.0f, 18448.0f, 20000.0f};
-		glNewList(sunsetlist, GL_COMPILE);
-			glBindTexture(GL_TEXTURE_2D, sunsettex);
-			glBegin(GL_TRIANGLE_STRIP);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.0f);
-				glVertex3f(vert[0], vert[2], vert[5]);
-				glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(0.0f, 0.0f);
-				glVertex3f(vert[0], vert[0], vert[5]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.125f);
-				glVertex3f(-vert[1], vert[2], vert[4]);
-				glColor3f(0.25f, 0.25f, 0.25f);
-				glTexCoord2f(0.0f, 0.125f);
-				glVertex3f(-vert[1], vert[0], vert[4]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.25f);
-				glVertex3f(-vert[3], vert[2], vert[3]);
-				glColor3f(0.5f, 0.5f, 0.5f);
-				glTexCoord2f(0.0f, 0.25f);
-				glVertex3f(-vert[3], vert[0], vert[3]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.375f);
-				glVertex3f(-vert[4], vert[2], vert[1]);
-				glColor3f(0.75f, 0.75f, 0.75f);
-				glTexCoord2f(0.0f, 0.375f);
-				glVertex3f(-vert[4], vert[0], vert[1]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.5f);
-				glVertex3f(-vert[5], vert[2], vert[0]);
-				glColor3f(1.0f, 1.0f, 1.0f);
-				glTexCoord2f(0.0f, 0.5f);
-				glVertex3f(-vert[5], vert[0], vert[0]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.625f);
-				glVertex3f(-vert[4], vert[2], -vert[1]);
-				glColor3f(0.75f, 0.75f, 0.75f);
-				glTexCoord2f(0.0f, 0.625f);
-				glVertex3f(-vert[4], vert[0], -vert[1]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.75f);
-				glVertex3f(-vert[3], vert[2], -vert[3]);
-				glColor3f(0.5f, 0.5f, 0.5f);
-				glTexCoord2f(0.0f, 0.75f);
-				glVertex3f(-vert[3], vert[0], -vert[3]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 0.875f);
-				glVertex3f(-vert[1], vert[2], -vert[4]);
-				glColor3f(0.25f, 0.25f, 0.25f);
-				glTexCoord2f(0.0f, 0.875f);
-				glVertex3f(-vert[1], vert[0], -vert[4]);
-					glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(1.0f, 1.0f);
-				glVertex3f(vert[0], vert[2], -vert[5]);
-				glColor3f(0.0f, 0.0f, 0.0f);
-				glTexCoord2f(0.0f, 1.0f);
-				glVertex3f(vert[0], vert[0], -vert[5]);
-			glEnd();
-		glEndList();
-	}
-
-	// initialize earth geometry
-	if(inSettings->dEarth){
-		earthlist = glGenLists(1);
-		earthnearlist = glGenLists(1);
-		earthfarlist = glGenLists(1);
-		float lit[] = {float(inSettings->dAmbient) * 0.01f, float(inSettings->dAmbient) * 0.01f, float(inSettings->dAmbient) * 0.01f};
-		float unlit[] = {0.0f, 0.0f, 0.0f};
-		float vert[2] = {839.68f, 8396.8f};
-		float tex[4] = {0.0f, 0.45f, 0.55f, 1.0f};
-		glNewList(earthnearlist, GL_COMPILE);
-			glColor3fv(lit);
-			glBegin(GL_TRIANGLE_STRIP);
-				glTexCoord2f(tex[0], tex[0]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[0], tex[3]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[3], tex[0]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[3], tex[3]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-			glEnd();
-		glEndList();
-		glNewList(earthfarlist, GL_COMPILE);
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[1], tex[1]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[2], tex[1]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[0], tex[0]);
-				glVertex3f(-vert[1], 0.0f, -vert[1]);
-				glTexCoord2f(tex[3], tex[0]);
-				glVertex3f(vert[1], 0.0f, -vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[1], tex[2]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[1], tex[1]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[0], tex[3]);
-				glVertex3f(-vert[1], 0.0f, vert[1]);
-				glTexCoord2f(tex[0], tex[0]);
-				glVertex3f(-vert[1], 0.0f, -vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[2], tex[2]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[1], tex[2]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[3], tex[3]);
-				glVertex3f(vert[1], 0.0f, vert[1]);
-				glTexCoord2f(tex[0], tex[3]);
-				glVertex3f(-vert[1], 0.0f, vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[2], tex[1]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[2], tex[2]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[3], tex[0]);
-				glVertex3f(vert[1], 0.0f, -vert[1]);
-				glTexCoord2f(tex[3], tex[3]);
-				glVertex3f(vert[1], 0.0f, vert[1]);
-			glEnd();
-		glEndList();
-		glNewList(earthlist, GL_COMPILE);
-			lit[0] = lit[1] = lit[2] = 0.25f;
-			glColor3fv(lit);
-			glBegin(GL_TRIANGLE_STRIP);
-				glTexCoord2f(tex[1], tex[1]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[1], tex[2]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[2], tex[1]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[2], tex[2]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[1], tex[1]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[2], tex[1]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[0], tex[0]);
-				glVertex3f(-vert[1], 0.0f, -vert[1]);
-				glTexCoord2f(tex[3], tex[0]);
-				glVertex3f(vert[1], 0.0f, -vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[1], tex[2]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[1], tex[1]);
-				glVertex3f(-vert[0], 0.0f, -vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[0], tex[3]);
-				glVertex3f(-vert[1], 0.0f, vert[1]);
-				glTexCoord2f(tex[0], tex[0]);
-				glVertex3f(-vert[1], 0.0f, -vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[2], tex[2]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-				glTexCoord2f(tex[1], tex[2]);
-				glVertex3f(-vert[0], 0.0f, vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[3], tex[3]);
-				glVertex3f(vert[1], 0.0f, vert[1]);
-				glTexCoord2f(tex[0], tex[3]);
-				glVertex3f(-vert[1], 0.0f, vert[1]);
-			glEnd();
-			glBegin(GL_TRIANGLE_STRIP);
-				glColor3fv(lit);
-				glTexCoord2f(tex[2], tex[1]);
-				glVertex3f(vert[0], 0.0f, -vert[0]);
-				glTexCoord2f(tex[2], tex[2]);
-				glVertex3f(vert[0], 0.0f, vert[0]);
-				glColor3fv(unlit);
-				glTexCoord2f(tex[3], tex[0]);
-				glVertex3f(vert[1], 0.0f, -vert[1]);
-				glTexCoord2f(tex[3], tex[3]);
-				glVertex3f(vert[1], 0.0f, vert[1]);
-			glEnd();
-		glEndList();
-	}
-}
-
-
-// For building mountain sillohettes in sunset
-void World::makeHeights(int first, int last, int *h){
-	int middle;
-	int diff;
-
-	diff = last - first;
-	if(diff <= 1)
-		return;
-	middle = (first + last) / 2;
-	h[middle] = (h[first] + h[last]) / 2;
-	h[middle] += rsRandi(diff / 2) - (diff / 4);
-	if(h[middle] < 1)
-		h[middle] = 1;
-
-	makeHeights(first, middle, h);
-	makeHeights(middle, last, h);
 }
 
 
 void World::update(float frameTime, SkyrocketSaverSettings *inSettings){
-	const float recipHalfCloud = 1.0f / float(CLOUDMESH / 6);
-
 	if(inSettings->dClouds){
 		// Blow clouds (particles should get the same drift at 2000 feet)
 		// Maximum dWind is 100 and texture repeats every 6666.67 feet
 		// so 100 * 0.00015 * 6666.67 = 100 ft/sec maximum windspeed.
+		// The texture is shifted when the clouds are drawn (worldgl.cpp).
 		cloudShift += 0.00015f * float(inSettings->dWind) * frameTime;
 		while(cloudShift > 1.0f)
 			cloudShift -= 1.0f;
-		for(int j=0; j<=CLOUDMESH; ++j){
-			for(int i=0; i<=CLOUDMESH; ++i){
-				// darken clouds
+		// darken clouds that were lit last frame
+		for(int i=litWest; i<=litEast; ++i){
+			for(int j=litSouth; j<=litNorth; ++j){
 				clouds[i][j][6] = clouds[i][j][5];
 				clouds[i][j][7] = clouds[i][j][5];
 				clouds[i][j][8] = clouds[i][j][5];
-				// move clouds
-				clouds[i][j][3] = float(-i) * recipHalfCloud + cloudShift;
 			}
 		}
+		litWest = litSouth = 0;
+		litEast = litNorth = -1;
 	}
+	cloudLights.clear();
 }
 
-void World::draw(SkyrocketSaverSettings *inSettings){
-	int i, j;
-
-	glMatrixMode(GL_MODELVIEW);
-	glDisable(GL_DEPTH_TEST);
 
-	// draw stars
-	if(inSettings->dStardensity){
-		glDisable(GL_BLEND);
-		glCallList(starlist);
+void World::addCloudLight(const float* xyz, const float* rgb, float bright){
+	cloudLight light;
+	for(int k=0; k<3; ++k){
+		light.xyz[k] = xyz[k];
+		light.rgb[k] = rgb[k];
 	}
+	light.bright = bright;
+	// limits of cloud indices to inspect
+	const int halfmesh = CLOUDMESH / 2;
+	// remember clouds have 20000-foot radius from the World class, hence 0.00005
+	// Hardcoded values like this are evil, but oh well
+	light.south = int((xyz[2] - 1600.0f) * 0.00005f * float(halfmesh)) + halfmesh;
+	light.north = int((xyz[2] + 1600.0f) * 0.00005f * float(halfmesh) + 0.5f) + halfmesh;
+	light.west = int((xyz[0] - 1600.0f) * 0.00005f * float(halfmesh)) + halfmesh;
+	light.east = int((xyz[0] + 1600.0f) * 0.00005f * float(halfmesh) + 0.5f) + halfmesh;
+	// bound these values just in case
+	if(light.south < 0) light.south = 0; if(light.south > CLOUDMESH-1) light.south = CLOUDMESH-1;
+	if(light.north < 0) light.north = 0; if(light.north > CLOUDMESH-1) light.north = CLOUDMESH-1;
+	if(light.west < 0) light.west = 0; if(light.west > CLOUDMESH-1) light.west = CLOUDMESH-1;
+	if(light.east < 0) light.east = 0; if(light.east > CLOUDMESH-1) light.east = CLOUDMESH-1;
+	cloudLights.push_back(light);
+}
 
-	// draw moon
-	if(inSettings->dMoon){
-		glPushMatrix();
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glRotatef(moonRotation, 0, 1, 0);
-		glRotatef(moonHeight, 1, 0, 0);
-		glTranslatef(0.0f, 0.0f, -20000.0f);
-		glCallList(moonlist);
-		glPopMatrix();
-	}
 
-	// draw clouds
-	if(inSettings->dClouds){
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glBindTexture(GL_TEXTURE_2D, cloudtex);
-		for(j=0; j<CLOUDMESH; j++){
-			glBegin(GL_TRIANGLE_STRIP);
-			for(i=0; i<=CLOUDMESH; i++){
-				glColor3f(clouds[i][j+1][6], clouds[i][j+1][7], clouds[i][j+1][8]);
-				glTexCoord2f(clouds[i][j+1][3], clouds[i][j+1][4]);
-				glVertex3fv(clouds[i][j+1]);
-				glColor3f(clouds[i][j][6], clouds[i][j][7], clouds[i][j][8]);
-				glTexCoord2f(clouds[i][j][3], clouds[i][j][4]);
-				glVertex3fv(clouds[i][j]);
-			}
-			glEnd();
-		}
-	}
+void World::lightClouds(){
+	if(cloudLights.empty())
+		return;
 
-	// draw sunset
-	if(doSunset){
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_ONE, GL_ONE);
-		glCallList(sunsetlist);
+	// Everything lit this frame is inside this rectangle.  update() darkens it
+	// again at the start of next frame.
+	litWest = litSouth = CLOUDMESH;
+	litEast = litNorth = 0;
+	for(unsigned int n=0; n<cloudLights.size(); ++n){
+		const cloudLight& light(cloudLights[n]);
+		if(light.west < litWest) litWest = light.west;
+		if(light.east > litEast) litEast = light.east;
+		if(light.south < litSouth) litSouth = light.south;
+		if(light.north > litNorth) litNorth = light.north;
 	}
 
-	// draw moon's halo
-	if(inSettings->dMoonglow && inSettings->dMoon){
-		glPushMatrix();
-		float glow = float(inSettings->dMoonglow) * 0.005f;  // half of max possible value
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-		glRotatef(moonRotation, 0, 1, 0);
-		glRotatef(moonHeight, 1, 0, 0);
-		glTranslatef(0.0f, 0.0f, -20000.0f);
-		glColor4f(1.0f, 1.0f, 1.0f, glow);
-		glCallList(moonglowlist);  // halo
-		glScalef(6000.0f, 6000.0f, 6000.0f);
-		//glColor4f(1.0f, 1.0f, 1.0f, glow * 0.7f);
-		glCallList(inSettings->flarelist[0]);  // spot
-		glPopMatrix();
+	// Sort the lights into the tiles they reach, keeping them in order
+	const unsigned int tiles[3] = {CLOUDTILES, CLOUDTILES, 1};
+	cloudBins.boxes.resize(cloudLights.size());
+	for(unsigned int n=0; n<cloudLights.size(); ++n){
+		const cloudLight& light(cloudLights[n]);
+		cellBox& box(cloudBins.boxes[n]);
+		box.lo[0] = light.west / CLOUDTILE;
+		box.hi[0] = light.east / CLOUDTILE;
+		box.lo[1] = light.south / CLOUDTILE;
+		box.hi[1] = light.north / CLOUDTILE;
+		box.lo[2] = box.hi[2] = 0;
+		box.any = true;
 	}
-
-	// draw earth
-	if(inSettings->dEarth){
-		glPushMatrix();
-		glDisable(GL_BLEND);
-		glBindTexture(GL_TEXTURE_2D, earthneartex);
-		glCallList(earthnearlist);
-		glBindTexture(GL_TEXTURE_2D, earthfartex);
-		glCallList(earthfarlist);
-		if(inSettings->dAmbient <= 25){
-			glEnable(GL_BLEND);
-			glBlendFunc(GL_ONE, GL_ONE);
-			glBindTexture(GL_TEXTURE_2D, earthlighttex);
-			glCallList(earthlist);
+	cloudBins.sort(tiles);
+
+	// Gather light over each tile with only the lights that reach it.  The
+	// tile's vertices are copied out a column at a time so each light can be
+	// added to a run of them at once with SIMD.  Every vertex still adds its
+	// lights in the order they came in.
+	cloudTile tile;
+	for(int tj=0; tj<CLOUDTILES; ++tj){
+		for(int ti=0; ti<CLOUDTILES; ++ti){
+			const unsigned int* tileLights;
+			const unsigned int numLights(cloudBins.cellItems(tj * CLOUDTILES + ti, tileLights));
+			if(numLights == 0)
+				continue;
+			// only the vertices of the tile that its lights reach
+			int west(ti * CLOUDTILE + CLOUDTILE - 1), east(ti * CLOUDTILE);
+			int south(tj * CLOUDTILE + CLOUDTILE - 1), north(tj * CLOUDTILE);
+			for(unsigned int n=0; n<numLights; ++n){
+				const cloudLight& light(cloudLights[tileLights[n]]);
+				if(light.west < west) west = light.west;
+				if(light.east > east) east = light.east;
+				if(light.south < south) south = light.south;
+				if(light.north > north) north = light.north;
+			}
+			if(west < ti * CLOUDTILE) west = ti * CLOUDTILE;
+			if(east > ti * CLOUDTILE + CLOUDTILE - 1) east = ti * CLOUDTILE + CLOUDTILE - 1;
+			if(south < tj * CLOUDTILE) south = tj * CLOUDTILE;
+			if(north > tj * CLOUDTILE + CLOUDTILE - 1) north = tj * CLOUDTILE + CLOUDTILE - 1;
+			const int rows(north - south + 1);
+			for(int i=west; i<=east; ++i){
+				for(int j=south; j<=north; ++j){
+					const float* cloud(clouds[i][j]);
+					const int v((i - west) * rows + j - south);
+					tile.x[v] = cloud[0];
+					tile.y[v] = cloud[1];
+					tile.z[v] = cloud[2];
+					tile.r[v] = tile.g[v] = tile.b[v] = cloud[5];
+				}
+			}
+			for(unsigned int n=0; n<numLights; ++n){
+				const cloudLight& light(cloudLights[tileLights[n]]);
+				const int lw(light.west > west ? light.west : west);
+				const int le(light.east < east ? light.east : east);
+				const int first((light.south > south ? light.south : south) - south);
+				const int last((light.north < north ? light.north : north) - south + 1);
+				for(int i=lw; i<=le; ++i)
+					shine(light, tile, (i - west) * rows + first, (i - west) * rows + last);
+			}
+			for(int i=west; i<=east; ++i){
+				for(int j=south; j<=north; ++j){
+					float* cloud(clouds[i][j]);
+					const int v((i - west) * rows + j - south);
+					cloud[6] = tile.r[v];
+					cloud[7] = tile.g[v];
+					cloud[8] = tile.b[v];
+				}
+			}
 		}
-		glPopMatrix();
 	}
 }
@@ -27,6 +27,9 @@
 #define STARTEXSIZE 1024
 #define MOONGLOWTEXSIZE 128
 #define CLOUDMESH 70
+// Cloud lights are sorted into square tiles of this many vertices across
+#define CLOUDTILE 8
+#define CLOUDTILES ((CLOUDMESH + CLOUDTILE - 1) / CLOUDTILE)
 
 
 
@@ -37,39 +40,65 @@ extern int dMoonglow;
 extern int dMoon;
 extern int dClouds;
 extern int dEarth;*/
-#include <OpenGL/gl.h>
-#include <OpenGL/glu.h>
 #include "Skyrocket.h"
+#include <vector>
+
+
+// An explosion lighting the clouds this frame
+struct cloudLight{
+	float xyz[3];
+	float rgb[3];  // desaturated light color
+	float bright;
+	int west, east, south, north;  // cloud vertices it can reach
+};
 
 
 class World{
 public:
 	int doSunset;
 	float moonRotation, moonHeight;
-	float cloudShift;
+	float cloudShift;  // how far the wind has moved the cloud texture (added to u when drawing)
 	float stars[STARMESH+1][STARMESH/2][6];  // 6 = x,y,z,u,v,bright
 	float clouds[CLOUDMESH+1][CLOUDMESH+1][9];  // 9 = x,y,z,u,v,std bright,r,g,b
+	// Cloud vertices that were lit last frame and need to go back to std bright
+	int litWest, litEast, litSouth, litNorth;
+	std::vector<cloudLight> cloudLights;
+	cellBins cloudBins;  // cloudLights sorted into the tiles they reach
 	unsigned int starlist;
-	GLuint startex;
+	unsigned int startex;
 	unsigned int moonlist;
-	GLuint moontex;
+	unsigned int moontex;
 	unsigned int moonglowlist;
-	GLuint moonglowtex;
-	GLuint cloudtex;
-	GLuint sunsettex;
+	unsigned int moonglowtex;
+	unsigned int cloudtex;
+	// The cloud mesh lives in vertex buffers.  Positions and texture coordinates
+	// never change, so only the colors are sent again every frame.
+	unsigned int cloudBuffer;  // x,y,z,u,v for each clouds vertex
+	unsigned int cloudColorBuffer;  // r,g,b for each clouds vertex
+	unsigned int cloudIndexBuffer;  // triangles
+	unsigned int sunsettex;
 	unsigned int sunsetlist;
-	GLuint earthneartex;
-	GLuint earthfartex;
-	GLuint earthlighttex;
+	unsigned int earthneartex;
+	unsigned int earthfartex;
+	unsigned int earthlighttex;
 	unsigned int earthlist;
 	unsigned int earthnearlist;
 	unsigned int earthfarlist;
 
+	// The constructor and update() only touch the simulation's data (world.cpp).
+	// initGL(), cleanupGL(), and draw() are the OpenGL side (worldgl.cpp).
 	World(SkyrocketSaverSettings *inSettings);
 	~World(){}
+	void initGL(SkyrocketSaverSettings *inSettings);
+	// Delete the buffers initGL() made, while the OpenGL context is still current
+	void cleanupGL();
 	// For building mountain sillohettes in sunset
 	void makeHeights(int first, int last, int *h);
 	void update(float frameTime, SkyrocketSaverSettings *inSettings);
+	// Explosions add themselves as cloud lights while particles interact, and
+	// then lightClouds() lights the clouds with all of them at once.
+	void addCloudLight(const float* xyz, const float* rgb, float bright);
+	void lightClouds();
 	void draw(SkyrocketSaverSettings *inSettings);
 };
 